@@ -0,0 +1,40 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+#include <ldp/detail/crc.hpp>
+
+template <typename Engine> static void run(const char *name, const upd::byte_t *buf, std::size_t size) {
+  using namespace ldp::detail;
+  using clock = std::chrono::steady_clock;
+
+  constexpr std::size_t total = 1 << 26;
+  auto iterations = total / size;
+
+  volatile crc_t sink = 0;
+  auto start = clock::now();
+  for (std::size_t i = 0; i < iterations; ++i)
+    sink = Engine::advance(sink, buf, buf + size);
+  std::chrono::duration<double> elapsed = clock::now() - start;
+
+  std::printf("%-14s %6zu bytes %10.1f MB/s\n", name, size, iterations * size / elapsed.count() / 1e6);
+}
+
+int main() {
+  using namespace ldp::detail::crc_engine;
+
+  static upd::byte_t buf[4096];
+  std::uint32_t seed = 0x12345678;
+  for (auto &byte : buf) {
+    seed = seed * 1103515245 + 12345;
+    byte = seed >> 16;
+  }
+
+  for (std::size_t size : {16, 64, 256, 1024, 4096}) {
+    run<nibble>("nibble", buf, size);
+    run<bytewise>("bytewise", buf, size);
+    run<slicing_by_4>("slicing_by_4", buf, size);
+    run<slicing_by_8>("slicing_by_8", buf, size);
+  }
+}
@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include <ldp/detail/crc.hpp>
+#include <ldp/memzone.hpp>
+#include <ldp/packet.hpp>
+#include <ldp/ping.hpp>
+#include <ldp/read.hpp>
+#include <ldp/sentry.hpp>
+
+// Every measure is printed as an element of a JSON array, so that the output can be stored and compared between two
+// revisions. The latency of a packet is the duration of a batch divided by its number of packets, as the clock is
+// too coarse to time a single packet.
+
+struct stuffing_density {
+  const char *name;
+  std::size_t period;
+};
+
+constexpr std::size_t batch_size = 256;
+constexpr std::size_t total = 1 << 24;
+constexpr std::size_t min_batches = 64;
+
+static bool first_result = true;
+
+template <typename F>
+static void run(const char *name, std::size_t payload, const char *stuffing, std::size_t packet_size, F &&ftor) {
+  using clock = std::chrono::steady_clock;
+
+  auto batches = std::max(min_batches, total / (packet_size * batch_size));
+  std::vector<double> latencies(batches);
+
+  volatile std::size_t sink = 0;
+  auto start = clock::now();
+  for (auto &latency : latencies) {
+    auto batch_start = clock::now();
+    for (std::size_t i = 0; i < batch_size; ++i)
+      sink = sink + ftor();
+    std::chrono::duration<double, std::nano> elapsed = clock::now() - batch_start;
+    latency = elapsed.count() / batch_size;
+  }
+  std::chrono::duration<double> elapsed = clock::now() - start;
+
+  std::sort(latencies.begin(), latencies.end());
+  auto percentile = [&](double p) { return latencies[static_cast<std::size_t>(p * (latencies.size() - 1))]; };
+  auto packets = static_cast<double>(batches * batch_size);
+
+  std::printf("%s\n    {\"name\": \"%s\", \"payload\": %zu, \"stuffing\": \"%s\", \"packet_size\": %zu, "
+              "\"mb_per_s\": %.1f, \"packets_per_s\": %.0f, "
+              "\"latency_ns\": {\"p50\": %.1f, \"p90\": %.1f, \"p99\": %.1f, \"max\": %.1f}}",
+              first_result ? "" : ",", name, payload, stuffing, packet_size,
+              packets * packet_size / elapsed.count() / 1e6, packets / elapsed.count(), percentile(.5),
+              percentile(.9), percentile(.99), latencies.back());
+  first_result = false;
+}
+
+static void fill(upd::byte_t *begin, upd::byte_t *end, std::size_t period) {
+  std::uint32_t seed = 0x12345678;
+  for (auto ptr = begin; ptr != end; ++ptr) {
+    seed = seed * 1103515245 + 12345;
+    *ptr = std::min(seed >> 16 & 0xff, 0xfeu);
+  }
+
+  for (auto ptr = begin; period != 0 && end - ptr >= 3; ptr += period) {
+    ptr[0] = 0xff;
+    ptr[1] = 0xff;
+    ptr[2] = 0xfd;
+  }
+}
+
+int main() {
+  using namespace ldp;
+
+  static upd::byte_t parameters[1 + 1024], packet[2 * sizeof parameters], out[2 * sizeof parameters];
+  // At worst, every third parameter byte ends a segment
+  static packet_segment segments[3 + sizeof parameters / 3];
+  packet_envelope envelope;
+  const stuffing_density densities[] = {{"none", 0}, {"sparse", 64}, {"dense", 4}};
+
+  std::size_t pos = 0;
+  auto collect = [&](upd::byte_t byte) { out[pos++] = byte; };
+
+  std::printf("{\"benchmark\": \"packet\", \"results\": [");
+
+  run("encode_ping", 0, "none", 10, [&]() {
+    pos = 0;
+    ping(0x01) >> collect;
+    return out[pos - 1];
+  });
+
+  run("encode_read", 4, "none", 14, [&]() {
+    pos = 0;
+    read(0x01, memzone<132, std::int32_t>{}) >> collect;
+    return out[pos - 1];
+  });
+
+  for (std::size_t payload : {4, 16, 64, 256, 1024}) {
+    for (const auto &density : densities) {
+      fill(parameters, parameters + payload, density.period);
+
+      pos = 0;
+      write_packet(collect, upd::two_complement, 0x01, instruction::WRITE, parameters, parameters + payload);
+      auto size = pos;
+
+      run("encode_write", payload, density.name, size, [&]() {
+        pos = 0;
+        write_packet(collect, upd::two_complement, 0x01, instruction::WRITE, parameters, parameters + payload);
+        return out[pos - 1];
+      });
+
+      run("encode_write_buffer", payload, density.name, size, [&]() {
+        return out[write_packet(out, sizeof out, upd::two_complement, 0x01, instruction::WRITE, parameters,
+                                parameters + payload) -
+                   1];
+      });
+
+      run("encode_write_segments", payload, density.name, size, [&]() {
+        auto count = write_packet(segments, sizeof segments / sizeof *segments, envelope, upd::two_complement, 0x01,
+                                  instruction::WRITE, parameters, parameters + payload);
+        return count + envelope.crc[0];
+      });
+
+      run("crc", payload, density.name, size, [&]() {
+        detail::crc_t crc = 0;
+        detail::advance_crc(crc, out, out + size);
+        return crc;
+      });
+
+      // A status packet is made of the error field followed by the data
+      parameters[0] = 0;
+      fill(parameters + 1, parameters + 1 + payload, density.period);
+      auto status_size =
+          write_packet(packet, sizeof packet, upd::two_complement, 0x01, instruction::RETURN, parameters,
+                       parameters + 1 + payload);
+
+      run("sentry", payload, density.name, status_size, [&]() {
+        sentry s;
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < status_size; ++i)
+          count += s(packet[i]);
+        return count;
+      });
+
+      run("decode_status", payload, density.name, status_size, [&]() {
+        std::size_t i = 0;
+        sentry s;
+        while (!s(packet[i++]))
+          ;
+        auto maybe_id = read_headerless_packet([&]() { return packet[i++]; }, upd::two_complement, out,
+                                               out + payload);
+        return maybe_id ? *maybe_id : 0;
+      });
+    }
+  }
+
+  std::printf("\n]}\n");
+}
@@ -0,0 +1,58 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+#include <ldp/scanner.hpp>
+#include <ldp/sentry.hpp>
+
+template <typename F> static void run(const char *name, std::size_t size, F &&ftor) {
+  using clock = std::chrono::steady_clock;
+
+  constexpr std::size_t total = 1 << 28;
+  auto iterations = total / size;
+
+  volatile std::size_t sink = 0;
+  auto start = clock::now();
+  for (std::size_t i = 0; i < iterations; ++i)
+    sink = sink + ftor();
+  std::chrono::duration<double> elapsed = clock::now() - start;
+
+  std::printf("%-16s %6zu bytes %10.1f MB/s\n", name, size, iterations * size / elapsed.count() / 1e6);
+}
+
+int main() {
+  static upd::byte_t buf[4096];
+  static std::size_t positions[sizeof buf];
+
+  std::uint32_t seed = 0x12345678;
+  for (auto &byte : buf) {
+    seed = seed * 1103515245 + 12345;
+    byte = seed >> 16;
+  }
+  for (std::size_t i = 0; i + 4 <= sizeof buf; i += 15) {
+    buf[i] = 0xff;
+    buf[i + 1] = 0xff;
+    buf[i + 2] = 0xfd;
+    buf[i + 3] = 0x00;
+  }
+
+  for (std::size_t size : {64, 512, 4096}) {
+    run("sentry", size, [&]() {
+      ldp::sentry s;
+      std::size_t count = 0;
+      for (std::size_t i = 0; i < size; ++i)
+        count += s(buf[i]);
+      return count;
+    });
+    run("find_headers", size, [&]() { return ldp::find_headers(buf, buf + size, positions, sizeof buf); });
+    run("stuffing_sentry", size, [&]() {
+      ldp::stuffing_sentry s;
+      std::size_t count = 0;
+      for (std::size_t i = 0; i < size; ++i)
+        count += s(buf[i]);
+      return count;
+    });
+    run("find_stuffing", size, [&]() { return ldp::find_stuffing(buf, buf + size, positions, sizeof buf); });
+  }
+}
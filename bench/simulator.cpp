@@ -0,0 +1,60 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+#include <ldp/memzone.hpp>
+#include <ldp/read.hpp>
+#include <ldp/sentry.hpp>
+#include <ldp/simulator.hpp>
+#include <ldp/write.hpp>
+
+template <typename F> static void run(const char *name, std::size_t devices, unsigned long baudrate, F &&ftor) {
+  using clock = std::chrono::steady_clock;
+
+  ldp::simulator sim{baudrate};
+  for (std::size_t id = 0; id < devices; ++id)
+    sim.add(id);
+
+  constexpr std::size_t rounds = 2000;
+  std::size_t failures = 0;
+  auto start = clock::now();
+  for (std::size_t i = 0; i < rounds; ++i) {
+    for (std::size_t id = 0; id < devices; ++id)
+      failures += !ftor(sim, static_cast<ldp::packet_id>(id), i);
+  }
+  std::chrono::duration<double> elapsed = clock::now() - start;
+
+  auto report = sim.report();
+  auto transactions = rounds * devices;
+  std::printf("%-6s %4zu devices %8lu bauds %10.0f transactions/s %10.0f simulated/s %12.0f instructions/s%s\n", name,
+              devices, baudrate, transactions / elapsed.count(),
+              transactions / std::chrono::duration<double>(report.bus_time).count(), report.instructions_per_second(),
+              failures ? " (failures)" : "");
+}
+
+static bool await_header(ldp::simulator &sim) {
+  ldp::sentry s;
+  while (!s(sim())) {
+    if (sim.timed_out())
+      return false;
+  }
+  return true;
+}
+
+int main() {
+  using namespace ldp;
+
+  for (std::size_t devices : {1, 16, 252}) {
+    for (unsigned long baudrate : {57600ul, 1000000ul, 4500000ul}) {
+      run("read", devices, baudrate, [](simulator &sim, packet_id id, std::size_t) {
+        auto t = read(id, memzone<132, std::int32_t>{}) >> sim;
+        return await_header(sim) && (t << sim).has_value();
+      });
+      run("write", devices, baudrate, [](simulator &sim, packet_id id, std::size_t i) {
+        auto t = write(id, memzone<116, std::int32_t>{}, static_cast<std::int32_t>(i)) >> sim;
+        return await_header(sim) && (t << sim).has_value();
+      });
+    }
+  }
+}
@@ -0,0 +1,104 @@
+//! \file
+//! \brief Batch processing of received packets
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+
+#include <upd/format.hpp>
+#include <upd/tuple.hpp>
+#include <upd/type.hpp>
+
+#include "detail/packet.hpp"
+#include "packet.hpp"
+#include "scanner.hpp"
+#include "ticket.hpp"
+
+namespace ldp {
+inline namespace v2 {
+
+//! \brief Outcome of a call to 'decode_batch'
+struct batch_result {
+  //! \brief Number of packets processed, successfully or not
+  std::size_t count;
+
+  //! \brief Number of bytes at the start of the buffer which do not need to be kept for the next call
+  //! \details The remaining bytes are the start of a packet which has not been fully received yet.
+  std::size_t consumed;
+};
+
+//! \brief Decode every status packet of a contiguous buffer with the provided ticket
+//! \details
+//!   The buffer is walked once: each header is located with 'find_headers' and the packet following it is decoded as
+//!   'ticket::operator<<' would. The decoding of a packet never reads past the end of the field 'Length' it declares.
+//!   A field 'Length' too large for a status packet of the ticket is garbage: the packet is reported with
+//!   'error::BAD_LENGTH' and the search goes on from its header, rather than waiting for bytes which will never fit in
+//!   the buffer.
+//! \param tk Ticket used to decode each packet
+//! \param begin, end Buffer holding the packets (including their headers)
+//! \param values Array receiving the values of the successfully decoded packets
+//! \param errors Array receiving the status of each packet
+//! \param capacity Size of the 'values' and 'errors' arrays
+//! \return The number of packets processed and the number of bytes consumed
+template <upd::signed_mode Signed_Mode, typename T, typename... Ts>
+batch_result decode_batch(const ticket<Signed_Mode, T, Ts...> &tk, const upd::byte_t *begin, const upd::byte_t *end,
+                          T *values, error *errors, std::size_t capacity) {
+  using namespace detail;
+
+  constexpr auto fields_size = sizeof(packet_id) + sizeof(length_t);
+  constexpr auto min_length = sizeof(instruction_t) + sizeof(error_t) + sizeof(crc_t);
+  upd::tuple<upd::endianess::LITTLE, Signed_Mode, Ts...> parameters;
+  auto max_length =
+      max_status_size(static_cast<std::size_t>(parameters.end() - parameters.begin())) - sizeof header - fields_size;
+
+  auto ptr = begin;
+  std::size_t count = 0;
+  for (; count != capacity; ++count) {
+    std::size_t position;
+    if (find_headers(ptr, end, &position, 1) == 0) {
+      // The last bytes may be the start of a header
+      ptr = std::max(ptr, end - std::min<std::ptrdiff_t>(end - begin, sizeof header - 1));
+      break;
+    }
+
+    auto packet_begin = ptr + position + 1;
+    if (end - packet_begin < static_cast<std::ptrdiff_t>(fields_size)) {
+      ptr = packet_begin - sizeof header;
+      break;
+    }
+
+    std::size_t length = packet_begin[1] | packet_begin[2] << 8u;
+    if (length > max_length) {
+      errors[count] = error::BAD_LENGTH;
+      ptr = packet_begin;
+      continue;
+    }
+
+    auto packet_end = packet_begin + fields_size + length;
+    if (end - packet_begin < static_cast<std::ptrdiff_t>(fields_size + length)) {
+      ptr = packet_begin - sizeof header;
+      break;
+    }
+
+    if (length < min_length) {
+      errors[count] = error::BAD_LENGTH;
+    } else {
+      auto it = packet_begin;
+      auto maybe_value = tk << [&]() { return it != packet_end ? *it++ : upd::byte_t{0}; };
+      if (maybe_value) {
+        values[count] = *maybe_value;
+        errors[count] = error::OK;
+      } else {
+        errors[count] = maybe_value.error();
+      }
+    }
+
+    ptr = packet_end;
+  }
+
+  return {count, static_cast<std::size_t>(ptr - begin)};
+}
+
+} // namespace v2
+} // namespace ldp
@@ -0,0 +1,212 @@
+//! \file
+//! \brief Bulk read and bulk write instruction utilities
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <utility>
+
+#include <tl/expected.hpp>
+#include <upd/format.hpp>
+
+#include "detail/bus.hpp"
+#include "detail/index_sequence.hpp"
+#include "detail/sfinae.hpp"
+#include "memzone.hpp"
+#include "packet.hpp"
+#include "read.hpp"
+#include "request.hpp"
+#include "ticket.hpp"
+
+#include "detail/def.hpp"
+
+namespace ldp {
+inline namespace v2 {
+
+//! \brief Process the status packets following a bulk read request
+//! \tparam Signed_Mode Signed integer convention of the received packets
+//! \tparam Ts Types of the values extracted from the packets, in order of request
+template <upd::signed_mode Signed_Mode, typename... Ts> class bulk_read_ticket {
+public:
+  //! \brief Type of the values extracted from the packets
+  using result_t = std::tuple<tl::expected<device_data<Ts>, error>...>;
+
+  //! \brief Store the identifiers of the requested devices
+  //! \param ids Array of size 'sizeof...(Ts)' holding the identifiers, in order of request
+  explicit bulk_read_ticket(const packet_id *ids) { std::copy(ids, ids + sizeof...(Ts), m_ids); }
+
+  //! \brief Extract the values from the status packets of every device
+  //! \details
+  //!   As with 'ticket', the header of the first packet must have been consumed already. The header of each following
+  //!   packet is searched for, so that a packet which could not be read does not prevent reading the next ones. The
+  //!   search covers at most the size of one status packet, and stops when the functor times out if it has a member
+  //!   function 'timed_out' (like 'serial_bus').
+  //!
+  //!   The devices answer in order of request, so a packet coming from a later device means that the devices in
+  //!   between did not answer. Their entry results in 'error::TIMEOUT', as well as the entries of the devices whose
+  //!   packet was not found. Packets coming from devices which were not requested are skipped.
+  //! \param ftor Functor which delivers a byte each time it is called
+  //! \return The value or the error resulting from each packet
+  template <typename F, sfinae::require_input_ftor<F> = 0> result_t operator<<(F &&ftor) const {
+    constexpr auto count = sizeof...(Ts);
+    result_t results{timeout<Ts>()...};
+
+    std::size_t next = 0;
+    for (std::size_t i = 0; i < count && next < count; ++i) {
+      // The bytes left of the previous packet are searched through, whichever device sent it
+      if (i != 0 && !detail::seek_header(ftor, detail::max_status_size(largest(sizeof(Ts)...))))
+        break;
+
+      // The identifier tells which entry the packet answers, hence the type of its value
+      packet_id id = ftor();
+      auto slot = static_cast<std::size_t>(std::find(m_ids + next, m_ids + count, id) - m_ids);
+      if (slot == count)
+        continue;
+
+      bool replayed = false;
+      auto input = [&]() -> upd::byte_t { return replayed ? ftor() : (replayed = true, id); };
+      decode(input, slot, results, detail::make_index_sequence<count>{});
+      next = slot + 1;
+    }
+
+    return results;
+  }
+
+  //! \copybrief operator<<
+  //! \details
+  //!   Each byte of the packets is delivered by the provided iterator.
+  //! \param it Start of the first packet
+  //! \return The value or the error resulting from each packet
+  template <typename It, sfinae::require_is_iterator<It> = 0> result_t operator<<(It it) const {
+    return operator<<([&]() { return *it++; });
+  }
+
+private:
+  template <typename T> static tl::expected<device_data<T>, error> timeout() {
+    return tl::make_unexpected(error{error::TIMEOUT});
+  }
+
+  template <typename F, std::size_t... Is>
+  static void decode(F &ftor, std::size_t slot, result_t &results, detail::index_sequence<Is...>) {
+    int dummy[] = {0, (slot == Is ? (std::get<Is>(results) = ticket<Signed_Mode, device_data<Ts>, Ts>{} << ftor, 0)
+                                  : 0)...};
+    static_cast<void>(dummy);
+  }
+
+  constexpr static std::size_t largest(std::size_t size) { return size; }
+  template <typename... Sizes> constexpr static std::size_t largest(std::size_t size, Sizes... sizes) {
+    return size > largest(sizes...) ? size : largest(sizes...);
+  }
+
+  packet_id m_ids[sizeof...(Ts)];
+};
+
+namespace detail {
+
+//! \brief Parameter types of a bulk read instruction packet for one device
+template <typename T> struct bulk_read_entry {
+  using type = std::tuple<packet_id, address_t, std::uint16_t>;
+};
+
+//! \brief Parameter types of a bulk write instruction packet for one device
+template <typename T> struct bulk_write_entry {
+  using type = std::tuple<packet_id, address_t, std::uint16_t, T>;
+};
+
+} // namespace detail
+
+//! \brief Request class for a bulk read instruction
+//! \details The ticket keeps the identifiers of the target devices, so that it knows which of them did not answer.
+//! \tparam Signed_Mode Signed integer representation of the packets involved in the request
+//! \tparam Ts Types of the values to be read
+template <upd::signed_mode Signed_Mode, typename... Ts>
+class bulk_read_t : public detail::request_base<bulk_read_t<Signed_Mode, Ts...>, bulk_read_ticket<Signed_Mode, Ts...>> {
+  using packet_t =
+      typename detail::flat_request<Signed_Mode, no_response,
+                                    decltype(std::tuple_cat(
+                                        std::declval<typename detail::bulk_read_entry<Ts>::type>()...))>::type;
+
+public:
+  //! \brief Store the content of the instruction packet
+  //! \param entries Identifier of each target device, the start of the memory zone to read on and its size
+  explicit bulk_read_t(const typename detail::bulk_read_entry<Ts>::type &...entries)
+      : m_packet{detail::make_flat_request<packet_t>(broadcast, instruction::BULK_READ, std::tuple_cat(entries...),
+                                                     detail::make_index_sequence<3 * sizeof...(Ts)>{})},
+        m_ids{std::get<0>(entries)...} {}
+
+  //! \brief Call a functor on each byte of the packet
+  //! \param ftor The functor to call
+  //! \return A ticket that can interpret the responses from the target devices
+  template <typename F, sfinae::require_output_ftor<F> = 0> bulk_read_ticket<Signed_Mode, Ts...> write(F &&ftor) const {
+    m_packet.write(FWD(ftor));
+    return bulk_read_ticket<Signed_Mode, Ts...>{m_ids};
+  }
+
+private:
+  packet_t m_packet;
+  packet_id m_ids[sizeof...(Ts)];
+};
+
+//! \brief Request class for a bulk write instruction
+//! \tparam Signed_Mode Signed integer representation of the packets involved in the request
+//! \tparam Ts Types of the values to be written
+template <upd::signed_mode Signed_Mode, typename... Ts>
+using bulk_write_t =
+    typename detail::flat_request<Signed_Mode, no_response,
+                                  decltype(std::tuple_cat(
+                                      std::declval<typename detail::bulk_write_entry<Ts>::type>()...))>::type;
+
+//! \brief Prepare the content of a bulk read instruction packet
+//! \details The devices will answer in the order of the provided entries.
+//! \tparam Signed_Mode Signed integer representation of the packet
+//! \param entries Identifier of each target device and the memory zone to read on
+//! \return A request object that holds the necessary data for a bulk read instruction
+template <upd::signed_mode Signed_Mode, typename... Ids, address_t... Addresses, typename... Ts>
+bulk_read_t<Signed_Mode, Ts...> bulk_read(upd::signed_mode_h<Signed_Mode>,
+                                          const std::pair<Ids, memzone<Addresses, Ts>> &...entries) {
+  return bulk_read_t<Signed_Mode, Ts...>{
+      std::make_tuple(static_cast<packet_id>(entries.first), Addresses, static_cast<std::uint16_t>(sizeof(Ts)))...};
+}
+
+//! \copybrief bulk_read
+//! \details The devices will answer in the order of the provided entries.
+//! \param entries Identifier of each target device and the memory zone to read on
+//! \return A request object that holds the necessary data for a bulk read instruction
+template <typename... Ids, address_t... Addresses, typename... Ts>
+bulk_read_t<upd::signed_mode::TWO_COMPLEMENT, Ts...>
+bulk_read(const std::pair<Ids, memzone<Addresses, Ts>> &...entries) {
+  return bulk_read(upd::two_complement, entries...);
+}
+
+//! \brief Prepare the content of a bulk write instruction packet
+//! \details The packet is broadcast, therefore no device will answer it.
+//! \tparam Signed_Mode Signed integer representation of the packet
+//! \param entries Identifier of each target device, the memory zone to write on and the value to write
+//! \return A request object that holds the necessary data for a bulk write instruction
+template <upd::signed_mode Signed_Mode, typename... Ids, address_t... Addresses, typename... Ts, typename... Us>
+bulk_write_t<Signed_Mode, Ts...> bulk_write(upd::signed_mode_h<Signed_Mode>,
+                                            const std::tuple<Ids, memzone<Addresses, Ts>, Us> &...entries) {
+  return detail::make_flat_request<bulk_write_t<Signed_Mode, Ts...>>(
+      broadcast, instruction::BULK_WRITE,
+      std::tuple_cat(std::make_tuple(static_cast<packet_id>(std::get<0>(entries)), Addresses,
+                                     static_cast<std::uint16_t>(sizeof(Ts)), static_cast<Ts>(std::get<2>(entries)))...),
+      detail::make_index_sequence<4 * sizeof...(Ts)>{});
+}
+
+//! \copybrief bulk_write
+//! \details The packet is broadcast, therefore no device will answer it.
+//! \param entries Identifier of each target device, the memory zone to write on and the value to write
+//! \return A request object that holds the necessary data for a bulk write instruction
+template <typename... Ids, address_t... Addresses, typename... Ts, typename... Us>
+bulk_write_t<upd::signed_mode::TWO_COMPLEMENT, Ts...>
+bulk_write(const std::tuple<Ids, memzone<Addresses, Ts>, Us> &...entries) {
+  return bulk_write(upd::two_complement, entries...);
+}
+
+} // namespace v2
+} // namespace ldp
+
+#include "detail/undef.hpp" // IWYU pragma: keep
@@ -0,0 +1,318 @@
+//! \file
+//! \brief Device control table description and access planning
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+
+#include <tl/expected.hpp>
+#include <upd/format.hpp>
+#include <upd/tuple.hpp>
+#include <upd/type.hpp>
+
+#include "detail/sfinae.hpp"
+#include "detail/type_list.hpp"
+#include "memzone.hpp"
+#include "packet.hpp"
+#include "read.hpp"
+#include "request.hpp"
+#include "ticket.hpp"
+
+#include "detail/def.hpp"
+
+namespace ldp {
+inline namespace v2 {
+
+//! \brief Values associated with a set of memory zones
+//! \details Each value is accessed with the memory zone it is associated with, e.g. 'f.get<present_position>()'.
+//! \tparam Zones Memory zones ('memzone' instances)
+template <typename... Zones> class fields {
+public:
+  //! \brief Value-initialize every value
+  fields() : m_values{} {}
+
+  //! \brief Initialize the values in the order of 'Zones'
+  explicit fields(const typename Zones::type &...values) : m_values{values...} {}
+
+  //! \brief Access the value associated with a memory zone
+  //! \tparam Zone One of the memory zones of 'Zones'
+  template <typename Zone> typename Zone::type &get() {
+    return std::get<detail::index_of<Zone, Zones...>::value>(m_values);
+  }
+
+  //! \copydoc get
+  template <typename Zone> const typename Zone::type &get() const {
+    return std::get<detail::index_of<Zone, Zones...>::value>(m_values);
+  }
+
+private:
+  std::tuple<typename Zones::type...> m_values;
+};
+
+namespace detail {
+
+//! \brief Contiguous range of device memory covering a set of memory zones
+//! \tparam Address Start of the range
+//! \tparam Length Size of the range
+//! \tparam Zones 'type_list' of the memory zones in the range, sorted by address
+template <address_t Address, std::size_t Length, typename Zones> struct window {
+  constexpr static address_t address = Address;
+  constexpr static std::size_t length = Length;
+  using zones = Zones;
+};
+
+template <address_t Address, std::size_t Length, typename Zones>
+constexpr address_t window<Address, Length, Zones>::address;
+template <address_t Address, std::size_t Length, typename Zones>
+constexpr std::size_t window<Address, Length, Zones>::length;
+
+//! \brief Sort a 'type_list' of memory zones by address
+template <typename Zone, typename Sorted> struct insert_zone;
+template <typename Zone> struct insert_zone<Zone, type_list<>> {
+  using type = type_list<Zone>;
+};
+template <typename Zone, typename Head, typename... Tail> struct insert_zone<Zone, type_list<Head, Tail...>> {
+  using type =
+      typename std::conditional<(Zone::address <= Head::address), identity<type_list<Zone, Head, Tail...>>,
+                                prepend<Head, typename insert_zone<Zone, type_list<Tail...>>::type>>::type::type;
+};
+template <typename List> struct sort_zones;
+template <> struct sort_zones<type_list<>> {
+  using type = type_list<>;
+};
+template <typename Zone, typename... Zones> struct sort_zones<type_list<Zone, Zones...>> {
+  using type = typename insert_zone<Zone, typename sort_zones<type_list<Zones...>>::type>::type;
+};
+
+//! \brief Group sorted memory zones into windows
+//! \details Two consecutive zones are put in the same window if at most 'Gap' bytes separate them.
+template <std::size_t Gap, typename Done, typename Current, typename Remaining> struct group_zones;
+template <std::size_t Gap, typename Done, typename Current> struct group_zones<Gap, Done, Current, type_list<>> {
+  using type = typename append<Done, Current>::type;
+};
+template <std::size_t Gap, typename Done, address_t Address, std::size_t Length, typename... Zones, typename Zone,
+          typename... Remaining>
+struct group_zones<Gap, Done, window<Address, Length, type_list<Zones...>>, type_list<Zone, Remaining...>> {
+  static_assert(Zone::address >= Address + Length, "Memory zones must not overlap");
+
+  constexpr static std::size_t end = Zone::address + sizeof(typename Zone::type);
+  using type = typename std::conditional<
+      (Zone::address - (Address + Length) <= Gap),
+      group_zones<Gap, Done, window<Address, end - Address, type_list<Zones..., Zone>>, type_list<Remaining...>>,
+      group_zones<Gap, typename append<Done, window<Address, Length, type_list<Zones...>>>::type,
+                  window<Zone::address, sizeof(typename Zone::type), type_list<Zone>>,
+                  type_list<Remaining...>>>::type::type;
+};
+
+//! \brief Make the fewest windows covering a set of sorted memory zones
+template <std::size_t Gap, typename Sorted> struct group_sorted_zones;
+template <std::size_t Gap, typename Zone, typename... Zones>
+struct group_sorted_zones<Gap, type_list<Zone, Zones...>>
+    : group_zones<Gap, type_list<>, window<Zone::address, sizeof(typename Zone::type), type_list<Zone>>,
+                  type_list<Zones...>> {};
+
+//! \brief Alias of the fewest windows covering a set of memory zones
+//! \tparam Gap Maximum number of unrequested bytes a window may cover between two memory zones
+//! \tparam Zones Memory zones to cover (in any order)
+template <std::size_t Gap, typename... Zones>
+using plan_t = typename group_sorted_zones<Gap, typename sort_zones<type_list<Zones...>>::type>::type;
+
+//! \brief Window of a 'type_list' holding a single one
+template <typename Windows> struct single_window;
+template <typename Window> struct single_window<type_list<Window>> {
+  using type = Window;
+};
+
+//! \brief Number of windows of a 'type_list'
+template <typename Windows> struct window_count;
+template <typename... Windows>
+struct window_count<type_list<Windows...>> : std::integral_constant<std::size_t, sizeof...(Windows)> {};
+
+//! \brief Alias of the window covering a set of memory zones, including the bytes between them
+template <typename... Zones>
+using read_window_t = typename single_window<plan_t<std::numeric_limits<std::size_t>::max(), Zones...>>::type;
+
+//! \brief Deserialize a value from a byte sequence
+template <upd::signed_mode Signed_Mode, typename T> T decode_value(const upd::byte_t *src) {
+  upd::tuple<upd::endianess::LITTLE, Signed_Mode, T> value;
+  std::copy(src, src + (value.end() - value.begin()), value.begin());
+  return upd::get<0>(value);
+}
+
+//! \brief Serialize a value into a byte sequence
+template <upd::signed_mode Signed_Mode, typename T> void encode_value(const T &value, upd::byte_t *dest) {
+  auto bytes = upd::make_tuple(upd::little_endian, upd::signed_mode_h<Signed_Mode>{}, value);
+  std::copy(bytes.begin(), bytes.end(), dest);
+}
+
+} // namespace detail
+
+//! \brief Process the status packet following a read request issued by a control table
+//! \tparam Signed_Mode Signed integer convention of the received packet
+//! \tparam Window Window read by the request
+//! \tparam Zones Memory zones to extract from the window
+template <upd::signed_mode Signed_Mode, typename Window, typename... Zones> class fields_read_ticket {
+public:
+  //! \brief Extract the values of the memory zones from a packet
+  //! \param ftor Functor which delivers a byte each time it is called
+  template <typename F, sfinae::require_input_ftor<F> = 0>
+  tl::expected<device_data<fields<Zones...>>, error> operator<<(F &&ftor) const {
+    upd::byte_t buf[Window::length];
+    auto maybe_id = read_headerless_packet(FWD(ftor), upd::signed_mode_h<Signed_Mode>{}, buf, buf + sizeof buf);
+
+    return maybe_id.map([&](packet_id id) -> device_data<fields<Zones...>> {
+      device_data<fields<Zones...>> retval;
+      retval.id = id;
+      retval.value = fields<Zones...>{
+          detail::decode_value<Signed_Mode, typename Zones::type>(buf + Zones::address - Window::address)...};
+      return retval;
+    });
+  }
+
+  //! \copybrief operator<<
+  //! \param it Start of the packet
+  template <typename It, sfinae::require_is_iterator<It> = 0>
+  tl::expected<device_data<fields<Zones...>>, error> operator<<(It it) const {
+    return operator<<([&]() { return *it++; });
+  }
+};
+
+//! \brief Request writing a byte sequence known at construction into a device memory
+//! \tparam Signed_Mode Signed integer representation of the packets involved in the request
+//! \tparam Size Number of bytes to write
+template <upd::signed_mode Signed_Mode, std::size_t Size>
+class raw_write_t : public detail::request_base<raw_write_t<Signed_Mode, Size>, ticket<Signed_Mode, packet_id>> {
+public:
+  //! \brief Store the identifier of the target device and the start of the memory to write on
+  //! \details The bytes are then written in 'data()'.
+  explicit raw_write_t(packet_id id, address_t address) : m_id{id} {
+    detail::encode_value<Signed_Mode>(address, m_buf);
+  }
+
+  //! \brief Bytes to write
+  upd::byte_t *data() { return m_buf + sizeof(address_t); }
+
+  //! \brief Call a functor on each byte of the packet
+  //! \param ftor The functor to call
+  //! \return A ticket that can interpret the response from the target device
+  template <typename F, sfinae::require_output_ftor<F> = 0> ticket<Signed_Mode, packet_id> write(F &&ftor) const {
+    write_packet(FWD(ftor), upd::signed_mode_h<Signed_Mode>{}, m_id, instruction::WRITE, m_buf, m_buf + sizeof m_buf);
+    return {};
+  }
+
+private:
+  packet_id m_id;
+  upd::byte_t m_buf[sizeof(address_t) + Size];
+};
+
+//! \brief Request class reading a set of memory zones with a single read instruction
+//! \tparam Signed_Mode Signed integer representation of the packets involved in the request
+//! \tparam Zones Memory zones to read
+template <upd::signed_mode Signed_Mode, typename... Zones>
+using fields_read_t = request<Signed_Mode, fields_read_ticket<Signed_Mode, detail::read_window_t<Zones...>, Zones...>,
+                              address_t, std::uint16_t>;
+
+namespace detail {
+
+//! \brief Alias of the write requests of a 'type_list' of windows
+template <upd::signed_mode Signed_Mode, typename Windows> struct window_writes;
+template <upd::signed_mode Signed_Mode, typename... Windows>
+struct window_writes<Signed_Mode, type_list<Windows...>> {
+  using type = std::tuple<raw_write_t<Signed_Mode, Windows::length>...>;
+};
+
+//! \brief Make the write request of a window
+template <upd::signed_mode Signed_Mode, typename... Zones, address_t Address, std::size_t Length, typename... Ws>
+raw_write_t<Signed_Mode, Length> make_window_write(packet_id id, const fields<Zones...> &values,
+                                                   window<Address, Length, type_list<Ws...>>) {
+  raw_write_t<Signed_Mode, Length> retval{id, Address};
+  int dummy[] = {(encode_value<Signed_Mode>(values.template get<Ws>(), retval.data() + Ws::address - Address), 0)...};
+  static_cast<void>(dummy);
+  return retval;
+}
+
+//! \brief Make the write requests of a 'type_list' of windows
+template <upd::signed_mode Signed_Mode, typename... Zones, typename... Windows>
+typename window_writes<Signed_Mode, type_list<Windows...>>::type
+make_window_writes(packet_id id, const fields<Zones...> &values, type_list<Windows...>) {
+  return typename window_writes<Signed_Mode, type_list<Windows...>>::type{
+      make_window_write<Signed_Mode>(id, values, Windows{})...};
+}
+
+} // namespace detail
+
+//! \brief Write requests setting a set of memory zones, one write instruction per contiguous range
+//! \details
+//!   This is a 'std::tuple' of requests, in order of address. The devices share the bus, so each request must be sent
+//!   once the status packet of the previous one has been received.
+//! \tparam Signed_Mode Signed integer representation of the packets involved in the requests
+//! \tparam Zones Memory zones to write
+template <upd::signed_mode Signed_Mode, typename... Zones>
+using fields_write_t = typename detail::window_writes<Signed_Mode, detail::plan_t<0, Zones...>>::type;
+
+//! \brief Describes the memory layout of a device model
+//! \details
+//!   The memory zones are the fields of the control table of the device. Several fields can be read or written at once
+//!   with the fewest instructions:
+//!     - one read instruction covering every requested field (the unrequested bytes in between are discarded)
+//!     - one write instruction per group of adjacent fields, each sent after the response to the previous one
+//! \tparam Zones Memory zones of the control table ('memzone' instances which must not overlap)
+template <typename... Zones> struct control_table {
+  //! \brief Memory zones of the control table, sorted by address
+  using layout_t = detail::plan_t<0, Zones...>;
+
+  //! \brief Prepare a read instruction covering the given fields
+  //! \tparam Zs Fields to read
+  //! \tparam Signed_Mode Signed integer representation of the packet
+  //! \param id Identifier of the target device
+  //! \return A request object whose ticket extracts a 'device_data<fields<Zs...>>'
+  template <typename... Zs, upd::signed_mode Signed_Mode>
+  static fields_read_t<Signed_Mode, Zs...> read(upd::signed_mode_h<Signed_Mode>, packet_id id) {
+    static_assert(detail::all_of<detail::contains<Zs, Zones...>::value...>::value,
+                  "Every field must be part of the control table");
+    using window_t = detail::read_window_t<Zs...>;
+    return fields_read_t<Signed_Mode, Zs...>{id, instruction::READ, window_t::address, window_t::length};
+  }
+
+  //! \copybrief read
+  //! \tparam Zs Fields to read
+  //! \param id Identifier of the target device
+  //! \return A request object whose ticket extracts a 'device_data<fields<Zs...>>'
+  template <typename... Zs> static fields_read_t<upd::signed_mode::TWO_COMPLEMENT, Zs...> read(packet_id id) {
+    return read<Zs...>(upd::two_complement, id);
+  }
+
+  //! \brief Prepare the write instructions covering the given fields
+  //! \tparam Signed_Mode Signed integer representation of the packets
+  //! \tparam Zs Fields to write
+  //! \param id Identifier of the target device
+  //! \param values Values to write
+  //! \return A 'std::tuple' of request objects, one per write instruction (see 'fields_write_t')
+  template <upd::signed_mode Signed_Mode, typename... Zs>
+  static fields_write_t<Signed_Mode, Zs...> write(upd::signed_mode_h<Signed_Mode>, packet_id id,
+                                                  const fields<Zs...> &values) {
+    static_assert(detail::all_of<detail::contains<Zs, Zones...>::value...>::value,
+                  "Every field must be part of the control table");
+    return detail::make_window_writes<Signed_Mode>(id, values, detail::plan_t<0, Zs...>{});
+  }
+
+  //! \copybrief write
+  //! \tparam Zs Fields to write
+  //! \param id Identifier of the target device
+  //! \param values Values to write
+  //! \return A 'std::tuple' of request objects, one per write instruction (see 'fields_write_t')
+  template <typename... Zs>
+  static fields_write_t<upd::signed_mode::TWO_COMPLEMENT, Zs...> write(packet_id id, const fields<Zs...> &values) {
+    return write(upd::two_complement, id, values);
+  }
+};
+
+} // namespace v2
+} // namespace ldp
+
+#include "detail/undef.hpp" // IWYU pragma: keep
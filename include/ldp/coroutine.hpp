@@ -0,0 +1,316 @@
+//! \file
+//! \brief Coroutine interface (C++20)
+//! \details
+//!   This header is empty when the compiler does not support coroutines, so that the rest of the library is still
+//!   usable with C++11.
+
+#pragma once
+
+#if defined(__cpp_impl_coroutine)
+
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include <tl/expected.hpp>
+#include <upd/type.hpp>
+
+#include "detail/bus.hpp"
+#include "detail/packet.hpp"
+#include "instrumentation.hpp"
+#include "packet.hpp"
+#include "parser.hpp"
+#include "ticket.hpp"
+
+#include "detail/def.hpp"
+
+namespace ldp {
+inline namespace v2 {
+
+template <typename Bus, std::size_t Capacity> class async_bus;
+
+namespace detail {
+
+//! \brief Operation queued on an 'async_bus'
+template <typename Bus> struct async_operation {
+  async_operation *next;
+  bool (*start)(async_operation &, Bus &);
+  void (*finish)(async_operation &, const tl::expected<frame, error> &);
+  std::coroutine_handle<> continuation;
+  packet_id id;
+};
+
+//! \brief Output functor forwarding an instruction packet to a bus and keeping the identifier of its target
+template <typename Bus> struct target_recorder {
+  Bus *bus;
+  std::size_t count;
+  packet_id id;
+
+  void operator()(upd::byte_t byte) {
+    if (count++ == sizeof header)
+      id = byte;
+    (*bus)(byte);
+  }
+};
+
+//! \brief Decode the response to a request with its ticket
+template <typename Tk> struct exchange;
+
+template <upd::signed_mode Signed_Mode, typename T, typename... Ts> struct exchange<ticket<Signed_Mode, T, Ts...>> {
+  using result_type = tl::expected<T, error>;
+
+  constexpr static bool answered = true;
+
+  static result_type decode(const ticket<Signed_Mode, T, Ts...> &tk, const tl::expected<frame, error> &maybe_frame) {
+    return maybe_frame ? tk << *maybe_frame : result_type{tl::make_unexpected(maybe_frame.error())};
+  }
+};
+
+template <> struct exchange<no_response> {
+  using result_type = error;
+
+  constexpr static bool answered = false;
+
+  static result_type decode(const no_response &, const tl::expected<frame, error> &) { return error::OK; }
+};
+
+} // namespace detail
+
+//! \brief Awaitable sending a request on a bus
+//! \details
+//!   The awaiting coroutine is suspended until the response has been received by its 'async_bus' or the deadline of
+//!   the request has passed. It then resumes with 'tl::expected<T, error>', 'T' being the type of the value extracted
+//!   by the ticket, or with 'error::OK' if the request has no response. Destroying the awaitable (along with the frame
+//!   of the coroutine) withdraws the request from the bus.
+//! \tparam Bus Type of the bus
+//! \tparam Capacity Maximum size of the field 'Param' of the status packets
+//! \tparam R Type of the request
+template <typename Bus, std::size_t Capacity, typename R> class send_operation : detail::async_operation<Bus> {
+  using ticket_t = decltype(std::declval<R &>() >> std::declval<detail::target_recorder<Bus> &>());
+  using exchange_t = detail::exchange<ticket_t>;
+
+public:
+  //! \brief Type the awaiting coroutine resumes with
+  using result_type = typename exchange_t::result_type;
+
+  //! \brief Store the request to be sent on a bus
+  send_operation(async_bus<Bus, Capacity> &owner, R request)
+      : detail::async_operation<Bus>{nullptr, &send_operation::start, &send_operation::finish, {}, broadcast},
+        m_owner{&owner}, m_request{std::move(request)} {}
+
+  send_operation(const send_operation &) = delete;
+  send_operation &operator=(const send_operation &) = delete;
+
+  //! \brief Withdraw the request from the bus if it is still queued or awaiting its response
+  ~send_operation() { m_owner->withdraw(*this); }
+
+  //! \brief The request is always sent by the bus
+  bool await_ready() const noexcept { return false; }
+
+  //! \brief Queue the request on the bus
+  void await_suspend(std::coroutine_handle<> continuation) {
+    this->continuation = continuation;
+    m_owner->enqueue(*this);
+  }
+
+  //! \brief Result of the request
+  result_type await_resume() { return std::move(*m_result); }
+
+private:
+  static bool start(detail::async_operation<Bus> &op, Bus &bus) {
+    auto &self = static_cast<send_operation &>(op);
+    detail::target_recorder<Bus> recorder{&bus, 0, broadcast};
+    self.m_ticket.emplace(self.m_request >> recorder);
+    detail::flush_output(bus, 0);
+
+    self.id = recorder.id;
+    if constexpr (!exchange_t::answered)
+      self.m_result.emplace(error::OK);
+    return exchange_t::answered;
+  }
+
+  static void finish(detail::async_operation<Bus> &op, const tl::expected<frame, error> &maybe_frame) {
+    auto &self = static_cast<send_operation &>(op);
+    self.m_result.emplace(exchange_t::decode(*self.m_ticket, maybe_frame));
+  }
+
+  async_bus<Bus, Capacity> *m_owner;
+  R m_request;
+  std::optional<ticket_t> m_ticket;
+  std::optional<result_type> m_result;
+};
+
+//! \brief Bus on which coroutines await requests
+//! \details
+//!   The requests of every coroutine are queued and sent in order. Devices share the bus, so a request is sent once the
+//!   response to the previous one has been received or its deadline has passed. The queue is an intrusive list of the
+//!   awaitables, which live in the frames of the coroutines, so no memory is allocated.
+//!
+//!   Nothing blocks: the event loop calls 'receive' with the bytes received from the bus whenever it is readable (e.g.
+//!   when 'serial_bus::native_handle' is ready), and 'poll' when the deadline of the request in flight has passed
+//!   (see 'deadline'), as well as after starting coroutines. The bytes are parsed by a 'parser', and the coroutine
+//!   awaiting the request in flight resumes as soon as the status packet of its device is complete. If a malformed
+//!   packet was received before the deadline, it resumes with the corresponding error rather than 'error::TIMEOUT'.
+//!
+//!   Times are durations since the epoch of a clock chosen by the event loop, such as
+//!   'std::chrono::steady_clock::now().time_since_epoch()' or 'simulator::time()'.
+//!
+//!   A bus must be an output functor. If it has a member function 'flush', it is called after each instruction packet.
+//! \tparam Bus Type of the bus
+//! \tparam Capacity Maximum size of the field 'Param' of the status packets
+template <typename Bus, std::size_t Capacity = LDP_HOOK_BUFFER_SIZE> class async_bus {
+  template <typename, std::size_t, typename> friend class send_operation;
+
+  using operation_t = detail::async_operation<Bus>;
+
+public:
+  //! \brief Schedule the requests of a bus
+  //! \param bus Bus to send the requests on
+  //! \param timeout Time the response to a request is awaited for
+  async_bus(Bus &bus, std::chrono::nanoseconds timeout)
+      : m_bus{&bus}, m_timeout{timeout}, m_head{nullptr}, m_tail{nullptr}, m_size{0}, m_current{nullptr},
+        m_deadline{0}, m_failure{error::OK} {}
+
+  async_bus(const async_bus &) = delete;
+  async_bus &operator=(const async_bus &) = delete;
+
+  //! \brief Make an awaitable sending a request
+  //! \details The request is queued when the awaitable is awaited, and sent when its turn comes.
+  //! \param request Request to send
+  //! \return The awaitable
+  template <typename R> send_operation<Bus, Capacity, std::decay_t<R>> send(R &&request) {
+    return {*this, FWD(request)};
+  }
+
+  //! \brief Resume the coroutine awaiting the request in flight if its deadline has passed, then send the queued
+  //! requests until one awaits a response
+  //! \param now Current time
+  void poll(std::chrono::nanoseconds now) {
+    if (m_current != nullptr && now >= m_deadline) {
+      auto op = m_current;
+      auto err = m_failure.type != error::OK ? m_failure : error{error::TIMEOUT, false};
+      if (err.type == error::TIMEOUT)
+        detail::count_error(error::TIMEOUT);
+
+      m_current = nullptr;
+      m_parser.reset();
+      op->finish(*op, tl::make_unexpected(err));
+      advance(now);
+      op->continuation.resume();
+    }
+
+    advance(now);
+  }
+
+  //! \brief Process bytes received from the bus
+  //! \details
+  //!   The coroutine awaiting the request in flight resumes as soon as its response is complete, once the next request
+  //!   has been sent. The packets which do not answer the request in flight are ignored.
+  //! \param begin, end Received bytes
+  //! \param now Time the bytes were received at
+  void receive(const upd::byte_t *begin, const upd::byte_t *end, std::chrono::nanoseconds now) {
+    for (; begin != end; ++begin) {
+      operation_t *answered = nullptr;
+      m_parser.push(*begin, [&](const tl::expected<frame, error> &maybe_frame) {
+        if (m_current == nullptr)
+          return;
+        if (!maybe_frame) {
+          m_failure = maybe_frame.error();
+          return;
+        }
+        if (maybe_frame->ins != instruction::RETURN || (m_current->id != broadcast && maybe_frame->id != m_current->id))
+          return;
+
+        answered = m_current;
+        m_current = nullptr;
+        answered->finish(*answered, maybe_frame);
+      });
+
+      if (answered != nullptr) {
+        advance(now);
+        answered->continuation.resume();
+      }
+    }
+
+    poll(now);
+  }
+
+  //! \brief Indicates whether a request has been sent and awaits its response
+  bool in_flight() const { return m_current != nullptr; }
+
+  //! \brief Time by which the response to the request in flight must be received (only meaningful if 'in_flight')
+  std::chrono::nanoseconds deadline() const { return m_deadline; }
+
+  //! \brief Number of queued requests which have not been sent yet
+  std::size_t pending() const { return m_size; }
+
+  //! \brief Underlying bus
+  Bus &bus() { return *m_bus; }
+
+private:
+  void enqueue(operation_t &op) {
+    op.next = nullptr;
+    (m_tail != nullptr ? m_tail->next : m_head) = &op;
+    m_tail = &op;
+    ++m_size;
+  }
+
+  // The response to a withdrawn request is ignored once received, like any packet which answers no request, and the
+  // next request is sent by the next call to 'poll' or 'receive'
+  void withdraw(operation_t &op) {
+    if (m_current == &op) {
+      m_current = nullptr;
+      return;
+    }
+
+    operation_t *previous = nullptr;
+    for (auto it = m_head; it != nullptr; previous = it, it = it->next) {
+      if (it != &op)
+        continue;
+
+      (previous != nullptr ? previous->next : m_head) = op.next;
+      if (m_tail == &op)
+        m_tail = previous;
+      --m_size;
+      return;
+    }
+  }
+
+  // The requests without response are completed as soon as they are sent
+  void advance(std::chrono::nanoseconds now) {
+    while (m_current == nullptr && m_head != nullptr) {
+      auto op = m_head;
+      m_head = op->next;
+      if (m_head == nullptr)
+        m_tail = nullptr;
+      --m_size;
+
+      if (op->start(*op, *m_bus)) {
+        m_current = op;
+        m_deadline = now + m_timeout;
+        m_failure = error::OK;
+      } else {
+        op->continuation.resume();
+      }
+    }
+  }
+
+  Bus *m_bus;
+  std::chrono::nanoseconds m_timeout;
+  operation_t *m_head, *m_tail;
+  std::size_t m_size;
+  operation_t *m_current;
+  std::chrono::nanoseconds m_deadline;
+  error m_failure;
+  parser<Capacity> m_parser;
+};
+
+} // namespace v2
+} // namespace ldp
+
+#include "detail/undef.hpp" // IWYU pragma: keep
+
+#endif // defined(__cpp_impl_coroutine)
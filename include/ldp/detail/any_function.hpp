@@ -10,33 +10,32 @@
 namespace ldp {
 namespace detail {
 
-//! \brief Base class used to introduce an input functor of any type through virtual dispatch
-struct abstract_input_functor_base {
-  virtual upd::byte_t operator()() = 0;
-};
-
-//! \brief Input functor binder which provides a
-template <typename F> struct abstract_input_functor : abstract_input_functor_base {
-  F &ftor;
-
-  explicit abstract_input_functor(F &ftor) : ftor{ftor} {}
-
-  upd::byte_t operator()() final { return ftor(); };
-};
-
 //! \brief Arbitrary function type
 //! \details When forming a pointer to this type, the result may not necessarly be of the same type as 'void *' on Von
 //! Neumann architectures
 using any_function_t = void();
 
 //! \brief Common type of 'restore_and_call' template instances
-using restorer_t = error(any_function_t *, abstract_input_functor_base &&);
+using restorer_t = error(any_function_t *, const upd::byte_t *, const upd::byte_t *);
+
+//! \brief Restore the original type of a callback and call it on the arguments extracted from a byte sequence
+//! \details The byte sequence holds a packet without its header. It is never read past its end.
+template <typename F, typename Tk>
+inline error restore_and_call(any_function_t *callback_ptr, const upd::byte_t *begin, const upd::byte_t *end) {
+  auto &callback = *reinterpret_cast<F *>(callback_ptr);
+  auto maybe = Tk{} << [&]() { return begin != end ? *begin++ : upd::byte_t{0}; };
+  maybe.map(callback);
+  return maybe ? error::OK : maybe.error();
+}
+
+//! \brief Common type of 'restore_and_call_on_frame' template instances
+using frame_restorer_t = error(any_function_t *, const frame &);
 
-//! \brief Restore the original type of a callback and call it on the arguments got from the provided input functor
+//! \brief Restore the original type of a callback and call it on the arguments extracted from a parsed packet
 template <typename F, typename Tk>
-inline error restore_and_call(any_function_t *callback_ptr, abstract_input_functor_base &&input_ftor) {
+inline error restore_and_call_on_frame(any_function_t *callback_ptr, const frame &f) {
   auto &callback = *reinterpret_cast<F *>(callback_ptr);
-  auto maybe = Tk{} << input_ftor;
+  auto maybe = Tk{} << f;
   maybe.map(callback);
   return maybe ? error::OK : maybe.error();
 }
@@ -0,0 +1,47 @@
+//! \file
+//! \brief Bus handling utilities
+
+#pragma once
+
+#include <cstddef>
+
+#include "../instrumentation.hpp"
+#include "../sentry.hpp"
+
+namespace ldp {
+inline namespace v2 {
+namespace detail {
+
+//! \brief Send the buffered bytes of a bus if it buffers its output
+template <typename Bus> auto flush_output(Bus &bus, int) -> decltype(bus.flush(), void()) { bus.flush(); }
+template <typename Bus> void flush_output(Bus &, ...) {}
+
+//! \brief Indicates whether an input functor timed out, if it is able to tell
+template <typename F> auto input_timed_out(const F &ftor, int) -> decltype(static_cast<bool>(ftor.timed_out())) {
+  return ftor.timed_out();
+}
+template <typename F> bool input_timed_out(const F &, ...) { return false; }
+
+//! \brief Consume the bytes delivered by an input functor until the end of a header
+//! \details
+//!   At most 'budget' bytes are read, and the search stops as soon as the functor times out if it has a member function
+//!   'timed_out' (like 'serial_bus'), so that it ends even when no packet follows.
+//! \param ftor Functor which delivers a byte each time it is called
+//! \param budget Maximal number of bytes to read
+//! \return Whether a header was found
+template <typename F> bool seek_header(F &ftor, std::size_t budget) {
+  sentry s;
+  for (std::size_t read = 1; read <= budget; ++read) {
+    if (s(ftor())) {
+      count_header_search(read);
+      return true;
+    }
+    if (input_timed_out(ftor, 0))
+      return false;
+  }
+  return false;
+}
+
+} // namespace detail
+} // namespace v2
+} // namespace ldp
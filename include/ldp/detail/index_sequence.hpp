@@ -0,0 +1,27 @@
+//! \file
+//! \brief Compile-time integer sequences
+
+#pragma once
+
+#include <cstddef>
+
+namespace ldp {
+inline namespace v2 {
+namespace detail {
+
+//! \brief Sequence of indices (equivalent to 'std::index_sequence', which is not available in C++11)
+template <std::size_t... Is> struct index_sequence {};
+
+//! \brief Make the index sequence '0, 1, ..., N - 1'
+template <std::size_t N, std::size_t... Is>
+struct make_index_sequence_impl : make_index_sequence_impl<N - 1, N - 1, Is...> {};
+template <std::size_t... Is> struct make_index_sequence_impl<0, Is...> {
+  using type = index_sequence<Is...>;
+};
+
+//! \brief Alias of the index sequence '0, 1, ..., N - 1'
+template <std::size_t N> using make_index_sequence = typename make_index_sequence_impl<N>::type;
+
+} // namespace detail
+} // namespace v2
+} // namespace ldp
@@ -0,0 +1,114 @@
+//! \file
+//! \brief Byte sequence iterators
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+
+#include <upd/format.hpp>
+#include <upd/tuple.hpp>
+#include <upd/type.hpp>
+
+namespace ldp {
+inline namespace v2 {
+namespace detail {
+
+//! \brief Range defined by a pair of iterators
+template <typename It> struct range {
+  It first, last;
+
+  It begin() const { return first; }
+  It end() const { return last; }
+};
+
+//! \brief Iterates over the serialized content of a sequence of identifier / value pairs
+//! \details
+//!   The elements of the sequence must have an 'id' and a 'value' member. Each element is serialized as its identifier
+//!   followed by its value converted to 'T'.
+template <upd::signed_mode Signed_Mode, typename Id, typename T, typename It> class entry_iterator {
+  constexpr static auto entry_size = sizeof(Id) + sizeof(T);
+
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = upd::byte_t;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const upd::byte_t *;
+  using reference = upd::byte_t;
+
+  entry_iterator(It it, It end) : m_it{it}, m_end{end}, m_offset{0} { load(); }
+
+  upd::byte_t operator*() const { return m_entry[m_offset]; }
+
+  entry_iterator &operator++() {
+    if (++m_offset == entry_size) {
+      m_offset = 0;
+      ++m_it;
+      load();
+    }
+    return *this;
+  }
+
+  entry_iterator operator++(int) {
+    auto retval = *this;
+    ++*this;
+    return retval;
+  }
+
+  bool operator==(const entry_iterator &other) const { return m_it == other.m_it && m_offset == other.m_offset; }
+  bool operator!=(const entry_iterator &other) const { return !(*this == other); }
+
+private:
+  void load() {
+    if (m_it == m_end)
+      return;
+
+    auto entry = upd::make_tuple(upd::little_endian, upd::signed_mode_h<Signed_Mode>{}, static_cast<Id>(m_it->id),
+                                 static_cast<T>(m_it->value));
+    std::copy(entry.begin(), entry.end(), m_entry);
+  }
+
+  It m_it, m_end;
+  std::size_t m_offset;
+  upd::byte_t m_entry[entry_size];
+};
+
+//! \brief Iterates over a sequence then over another one
+template <typename It1, typename It2> class chain_iterator {
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = upd::byte_t;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const upd::byte_t *;
+  using reference = upd::byte_t;
+
+  chain_iterator(It1 first, It1 first_end, It2 second) : m_first{first}, m_first_end{first_end}, m_second{second} {}
+
+  upd::byte_t operator*() const { return m_first != m_first_end ? *m_first : *m_second; }
+
+  chain_iterator &operator++() {
+    if (m_first != m_first_end)
+      ++m_first;
+    else
+      ++m_second;
+    return *this;
+  }
+
+  chain_iterator operator++(int) {
+    auto retval = *this;
+    ++*this;
+    return retval;
+  }
+
+  bool operator==(const chain_iterator &other) const { return m_first == other.m_first && m_second == other.m_second; }
+  bool operator!=(const chain_iterator &other) const { return !(*this == other); }
+
+private:
+  It1 m_first, m_first_end;
+  It2 m_second;
+};
+
+} // namespace detail
+} // namespace v2
+} // namespace ldp
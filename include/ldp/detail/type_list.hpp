@@ -0,0 +1,52 @@
+//! \file
+//! \brief Compile-time type lists
+
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+namespace ldp {
+inline namespace v2 {
+namespace detail {
+
+//! \brief Sequence of types
+template <typename... Ts> struct type_list {};
+
+//! \brief Metafunction returning its parameter
+template <typename T> struct identity {
+  using type = T;
+};
+
+//! \brief Add a type at the front of a type list
+template <typename T, typename List> struct prepend;
+template <typename T, typename... Ts> struct prepend<T, type_list<Ts...>> {
+  using type = type_list<T, Ts...>;
+};
+
+//! \brief Add a type at the back of a type list
+template <typename List, typename T> struct append;
+template <typename... Ts, typename T> struct append<type_list<Ts...>, T> {
+  using type = type_list<Ts..., T>;
+};
+
+//! \brief Position of the first occurence of a type in a pack
+template <typename T, typename... Ts> struct index_of;
+template <typename T, typename... Ts> struct index_of<T, T, Ts...> : std::integral_constant<std::size_t, 0> {};
+template <typename T, typename U, typename... Ts>
+struct index_of<T, U, Ts...> : std::integral_constant<std::size_t, 1 + index_of<T, Ts...>::value> {};
+
+//! \brief Indicates whether a type is part of a pack
+template <typename T, typename... Ts> struct contains : std::false_type {};
+template <typename T, typename... Ts> struct contains<T, T, Ts...> : std::true_type {};
+template <typename T, typename U, typename... Ts> struct contains<T, U, Ts...> : contains<T, Ts...> {};
+
+//! \brief Sequence of booleans
+template <bool... Bs> struct bool_sequence {};
+
+//! \brief Indicates whether every condition of a pack is true
+template <bool... Bs> struct all_of : std::is_same<bool_sequence<Bs..., true>, bool_sequence<true, Bs...>> {};
+
+} // namespace detail
+} // namespace v2
+} // namespace ldp
@@ -0,0 +1,238 @@
+//! \file
+//! \brief Device side of the protocol: instruction packet decoding and status packet encoding
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include <tl/expected.hpp>
+#include <upd/type.hpp>
+
+#include "detail/packet.hpp"
+#include "memzone.hpp"
+#include "packet.hpp"
+#include "sentry.hpp"
+
+#include "detail/def.hpp"
+
+namespace ldp {
+inline namespace v2 {
+namespace detail {
+
+inline std::uint16_t load_u16(const upd::byte_t *src) { return static_cast<std::uint16_t>(src[0] | src[1] << 8u); }
+
+inline upd::byte_t *store_u16(std::uint16_t value, upd::byte_t *dest) {
+  *dest++ = value & 0xff;
+  *dest++ = value >> 8u;
+  return dest;
+}
+
+} // namespace detail
+
+//! \brief Decode an instruction packet (without header) held in a buffer
+//! \details
+//!   The byte stuffing is removed in place, so the returned frame refers to the buffer and nothing is copied. Neither
+//!   memory allocation nor exception is involved, so the function may be called from an interrupt handler. The packet
+//!   occupies the first '3 + Length' bytes of the buffer, 'Length' being the value of the field of the same name.
+//! \param begin, end Buffer holding the packet from the byte following its header on
+//! \return the decoded packet, otherwise :
+//!   - error::BAD_LENGTH if the buffer does not hold the whole packet
+//!   - error::RECEIVED_BAD_CRC if the packet CRC is incorrect
+//!   - error::INSTRUCTION if the packet is a status packet
+inline tl::expected<frame, error> decode_headerless_instruction(upd::byte_t *begin, upd::byte_t *end) {
+  using namespace detail;
+
+  constexpr auto fields_size = sizeof(packet_id) + sizeof(length_t) + sizeof(instruction_t);
+  ASSERT(end - begin >= static_cast<std::ptrdiff_t>(fields_size + sizeof(crc_t)), error::BAD_LENGTH);
+
+  std::size_t length = load_u16(begin + sizeof(packet_id));
+  ASSERT(length >= sizeof(instruction_t) + sizeof(crc_t), error::BAD_LENGTH);
+  ASSERT(static_cast<std::size_t>(end - begin) >= sizeof(packet_id) + sizeof(length_t) + length, error::BAD_LENGTH);
+
+  auto parameters = begin + fields_size;
+  auto crc_begin = begin + sizeof(packet_id) + sizeof(length_t) + length - sizeof(crc_t);
+
+  crc_t crc = 0;
+  advance_crc(crc, header);
+  advance_crc(crc, static_cast<const upd::byte_t *>(begin), static_cast<const upd::byte_t *>(crc_begin));
+  ASSERT(load_u16(crc_begin) == crc, error::RECEIVED_BAD_CRC);
+  ASSERT(begin[fields_size - 1] != static_cast<instruction_t>(instruction::RETURN), error::INSTRUCTION);
+
+  stuffing_sentry s;
+  auto dest = parameters;
+  for (auto src = parameters; src != crc_begin; ++src) {
+    *dest++ = *src;
+    if (s(*src) && src + 1 != crc_begin)
+      ++src;
+  }
+
+  return frame{begin[0], static_cast<instruction>(begin[fields_size - 1]), error::OK, parameters,
+               static_cast<std::size_t>(dest - parameters)};
+}
+
+//! \brief Memory access requested to a device by an instruction packet
+struct memory_access {
+  //! \brief Nature of the access
+  enum kind_t {
+    //! The device is not concerned by the instruction
+    NONE,
+    //! The device must answer with the content of its memory
+    READ,
+    //! The device must write 'data' into its memory
+    WRITE
+  };
+
+  //! \brief Nature of the access
+  kind_t kind;
+
+  //! \brief Start of the memory zone to access
+  address_t address;
+
+  //! \brief Size of the memory zone to access
+  std::uint16_t length;
+
+  //! \brief Values to write (null for a read access)
+  const upd::byte_t *data;
+
+  //! \brief Number of devices which answer before this one (for sync read and bulk read instructions)
+  std::size_t rank;
+
+  //! \brief Whether the device must send a status packet
+  bool respond;
+};
+
+//! \brief Extract the memory access a device must perform from an instruction packet
+//! \details
+//!   READ, WRITE, SYNC_READ, SYNC_WRITE, BULK_READ and BULK_WRITE instructions are supported. For other instructions
+//!   (e.g. PING), the access is 'memory_access::NONE' and 'respond' tells whether the device must answer. The
+//!   parameters of a READ or WRITE instruction addressed to another device are not checked.
+//! \param f Packet decoded by 'decode_headerless_instruction' or 'parser'
+//! \param self Identifier of the device
+//! \return the access to perform, or error::DATA_LENGTH if the parameters are inconsistent with the instruction
+inline tl::expected<memory_access, error> find_access(const frame &f, packet_id self) {
+  using detail::load_u16;
+
+  auto params = f.parameters;
+  auto size = f.size;
+  memory_access retval{memory_access::NONE, 0, 0, nullptr, 0, false};
+  auto targeted = f.id == self || f.id == broadcast;
+
+  switch (f.ins) {
+  case instruction::READ:
+    if (f.id != self)
+      return retval;
+    ASSERT(size == 4, error::DATA_LENGTH);
+    return memory_access{memory_access::READ, load_u16(params), load_u16(params + 2), nullptr, 0, true};
+  case instruction::WRITE:
+    if (!targeted)
+      return retval;
+    ASSERT(size >= 2, error::DATA_LENGTH);
+    return memory_access{memory_access::WRITE, load_u16(params), static_cast<std::uint16_t>(size - 2), params + 2, 0,
+                         f.id == self};
+  case instruction::SYNC_READ:
+    ASSERT(size >= 4, error::DATA_LENGTH);
+    for (std::size_t i = 4; i < size; ++i) {
+      if (params[i] == self)
+        return memory_access{memory_access::READ, load_u16(params), load_u16(params + 2), nullptr, i - 4, true};
+    }
+    return retval;
+  case instruction::SYNC_WRITE: {
+    ASSERT(size >= 4, error::DATA_LENGTH);
+    std::size_t length = load_u16(params + 2);
+    ASSERT((size - 4) % (1 + length) == 0, error::DATA_LENGTH);
+    for (std::size_t i = 4; i < size; i += 1 + length) {
+      if (params[i] == self)
+        return memory_access{memory_access::WRITE, load_u16(params), static_cast<std::uint16_t>(length),
+                             params + i + 1, 0, false};
+    }
+    return retval;
+  }
+  case instruction::BULK_READ:
+    ASSERT(size % 5 == 0, error::DATA_LENGTH);
+    for (std::size_t i = 0; i < size; i += 5) {
+      if (params[i] == self)
+        return memory_access{memory_access::READ, load_u16(params + i + 1), load_u16(params + i + 3), nullptr, i / 5,
+                             true};
+    }
+    return retval;
+  case instruction::BULK_WRITE:
+    for (std::size_t i = 0; i != size;) {
+      ASSERT(size - i >= 5 && size - i - 5 >= load_u16(params + i + 3), error::DATA_LENGTH);
+      if (params[i] == self)
+        return memory_access{memory_access::WRITE, load_u16(params + i + 1), load_u16(params + i + 3), params + i + 5,
+                             0, false};
+      i += 5 + load_u16(params + i + 3);
+    }
+    return retval;
+  default:
+    retval.respond = f.id == self || (f.id == broadcast && f.ins == instruction::PING);
+    return retval;
+  }
+}
+
+//! \brief Encode a status packet into a buffer
+//! \details
+//!   The data are stuffed while being copied, then the CRC is computed over the finished packet. Neither memory
+//!   allocation nor exception is involved, so the function may be called from an interrupt handler.
+//! \param buf Start of the buffer to write on
+//! \param capacity Size of the buffer
+//! \param id Identifier of the device
+//! \param err Value of the field 'Error', with the alert flag
+//! \param data_begin, data_end Data to send (the values of the memory zone read, for instance)
+//! \return the number of bytes written, or zero if the buffer is too small to hold the packet
+inline std::size_t encode_status(upd::byte_t *buf, std::size_t capacity, packet_id id, error err,
+                                 const upd::byte_t *data_begin, const upd::byte_t *data_end) {
+  using namespace detail;
+
+  constexpr auto fields_size = sizeof header + sizeof(packet_id) + sizeof(length_t) + sizeof(instruction_t);
+  if (capacity < fields_size + sizeof(error_t) + static_cast<std::size_t>(data_end - data_begin) + sizeof(crc_t))
+    return 0;
+
+  auto ptr = buf + fields_size, end = buf + capacity - sizeof(crc_t);
+  stuffing_sentry s;
+  auto put = [&](upd::byte_t byte) {
+    if (s(byte)) {
+      if (ptr == end)
+        return false;
+      *ptr++ = stuffing_byte;
+    }
+    if (ptr == end)
+      return false;
+    *ptr++ = byte;
+    return true;
+  };
+
+  if (!put(static_cast<error_t>(err.type | (err.alert ? alert_bm : 0))))
+    return 0;
+  for (auto it = data_begin; it != data_end; ++it) {
+    if (!put(*it))
+      return 0;
+  }
+
+  std::copy(header, header + sizeof header, buf);
+  buf[sizeof header] = id;
+  store_u16(static_cast<length_t>(ptr - buf - fields_size + sizeof(instruction_t) + sizeof(crc_t)),
+            buf + sizeof header + sizeof(packet_id));
+  buf[fields_size - 1] = static_cast<instruction_t>(instruction::RETURN);
+
+  crc_t crc = 0;
+  advance_crc(crc, static_cast<const upd::byte_t *>(buf), static_cast<const upd::byte_t *>(ptr));
+  return store_u16(crc, ptr) - buf;
+}
+
+//! \copybrief encode_status
+//! \param buf Start of the buffer to write on
+//! \param capacity Size of the buffer
+//! \param id Identifier of the device
+//! \param err Value of the field 'Error', with the alert flag
+//! \return the number of bytes written, or zero if the buffer is too small to hold the packet
+inline std::size_t encode_status(upd::byte_t *buf, std::size_t capacity, packet_id id, error err) {
+  return encode_status(buf, capacity, id, err, nullptr, nullptr);
+}
+
+} // namespace v2
+} // namespace ldp
+
+#include "detail/undef.hpp" // IWYU pragma: keep
@@ -0,0 +1,453 @@
+//! \file
+//! \brief Parallel execution of requests over several buses
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <tl/expected.hpp>
+#include <upd/type.hpp>
+
+#include "bulk.hpp"
+#include "detail/bus.hpp"
+#include "instrumentation.hpp"
+#include "packet.hpp"
+#include "sentry.hpp"
+#include "sync_read.hpp"
+#include "ticket.hpp"
+
+#include "detail/def.hpp"
+
+#ifndef LDP_EXECUTOR_BUFFER_SIZE
+//! \brief Size of the buffers holding the instruction packet and the status packets of a job
+#define LDP_EXECUTOR_BUFFER_SIZE 256
+#endif // LDP_EXECUTOR_BUFFER_SIZE
+
+namespace ldp {
+inline namespace v2 {
+namespace detail {
+
+//! \brief Number of status packets answering a request, according to its ticket
+template <typename Tk> struct response_count;
+
+template <upd::signed_mode Signed_Mode, typename T, typename... Ts>
+struct response_count<ticket<Signed_Mode, T, Ts...>> {
+  static std::size_t of(packet_id id) { return id != broadcast ? 1 : 0; }
+};
+
+template <> struct response_count<no_response> {
+  static std::size_t of(packet_id) { return 0; }
+};
+
+template <upd::signed_mode Signed_Mode, typename T, std::size_t N>
+struct response_count<sync_read_ticket<Signed_Mode, T, N>> {
+  static std::size_t of(packet_id) { return N; }
+};
+
+template <upd::signed_mode Signed_Mode, typename T, std::size_t N>
+struct response_count<fast_sync_read_ticket<Signed_Mode, T, N>> {
+  static std::size_t of(packet_id) { return 1; }
+};
+
+template <upd::signed_mode Signed_Mode, typename... Ts> struct response_count<bulk_read_ticket<Signed_Mode, Ts...>> {
+  static std::size_t of(packet_id) { return sizeof...(Ts); }
+};
+
+//! \brief Request executed by the worker thread of a bus
+struct job {
+  //! \brief Largest number of status packets which fit in the buffer of a job
+  constexpr static std::size_t max_responses = (LDP_EXECUTOR_BUFFER_SIZE + sizeof header) / max_status_size(0);
+
+  upd::byte_t packet[LDP_EXECUTOR_BUFFER_SIZE];
+  std::size_t packet_size;
+  std::size_t responses;
+  upd::byte_t response[LDP_EXECUTOR_BUFFER_SIZE];
+  std::size_t response_size;
+  std::size_t received;
+  error status;
+  error statuses[max_responses];
+};
+
+//! \brief Output functor serializing an instruction packet into a job
+struct job_writer {
+  job *target;
+  bool overflow;
+
+  void operator()(upd::byte_t byte) {
+    if (target->packet_size == sizeof target->packet)
+      overflow = true;
+    else
+      target->packet[target->packet_size++] = byte;
+  }
+};
+
+//! \brief Input functor delivering the bytes received by a job, then zeros
+struct job_reader {
+  const upd::byte_t *ptr, *end;
+
+  upd::byte_t operator()() { return ptr != end ? *ptr++ : upd::byte_t{0}; }
+};
+
+} // namespace detail
+
+//! \brief Statistics of the jobs executed on a bus
+//! \details
+//!   The counters are updated by the worker thread with relaxed atomic operations, so they can be read at any time by
+//!   the control thread. Two counters read one after the other are not necessarily consistent with each other.
+struct executor_statistics {
+  //! \brief Number of jobs executed
+  std::atomic<std::uint32_t> jobs;
+
+  //! \brief Number of jobs of which a status packet was not fully received in time
+  std::atomic<std::uint32_t> timeouts;
+
+  //! \brief Duration of the last job in nanoseconds, from sending its instruction packet to receiving its last status
+  //! packet
+  std::atomic<std::uint64_t> last_ns;
+
+  //! \brief Longest duration of a job in nanoseconds
+  std::atomic<std::uint64_t> max_ns;
+
+  //! \brief Sum of the durations of the jobs in nanoseconds
+  std::atomic<std::uint64_t> total_ns;
+
+  //! \brief Initialize every statistic to zero
+  executor_statistics() : jobs{0}, timeouts{0}, last_ns{0}, max_ns{0}, total_ns{0} {}
+
+  //! \brief Average duration of a job
+  std::chrono::nanoseconds mean() const {
+    auto count = jobs.load(std::memory_order_relaxed);
+    return std::chrono::nanoseconds{count != 0 ? total_ns.load(std::memory_order_relaxed) / count : 0};
+  }
+};
+
+//! \brief Handle on the result of a request submitted to an executor
+//! \details
+//!   The result is available once the completion of the cycle the request belongs to has been reached. The handle
+//!   refers to a slot of the executor, which is reused after 'Depth' further submissions to the same bus.
+//! \tparam Tk Ticket of the request
+template <typename Tk> class pending {
+public:
+  //! \brief Make a handle on a job
+  pending(const detail::job &j, Tk tk) : m_job{&j}, m_ticket{tk} {}
+
+  //! \brief Ticket of the request
+  const Tk &ticket() const { return m_ticket; }
+
+  //! \brief Outcome of the transmission
+  //! \return
+  //!   'error::BAD_LENGTH' if the instruction packet did not fit in the job, otherwise the status of the first status
+  //!   packet which was not received (see 'status(std::size_t)'), or 'error::OK' if every one was
+  error status() const { return m_job->status; }
+
+  //! \brief Outcome of the reception of one status packet
+  //! \details
+  //!   Each status packet is awaited on its own, so a missing packet does not prevent the next ones from being
+  //!   received.
+  //! \param rank Rank of the status packet among the expected ones, in the order of arrival
+  //! \return 'error::TIMEOUT' if the packet was not fully received, 'error::BAD_LENGTH' if its field 'Length' does not
+  //!   fit in the buffer of the job, 'error::OK' otherwise
+  error status(std::size_t rank) const { return m_job->statuses[rank]; }
+
+  //! \brief Input functor delivering the received bytes
+  //! \details
+  //!   The bytes start after the header of the first status packet received, as expected by tickets. The following
+  //!   packets are delivered with their header. The packets which were not received are left out.
+  detail::job_reader response() const {
+    return detail::job_reader{m_job->response, m_job->response + m_job->response_size};
+  }
+
+  //! \brief Extract the value from the status packets with the ticket
+  //! \details The ticket is run as soon as one status packet was received, so it reports the missing ones itself.
+  //! \return The value extracted by the ticket, or the status of the transmission if no status packet was received
+  template <typename U = Tk>
+  auto get() const -> decltype(std::declval<const U &>() << std::declval<detail::job_reader &>()) {
+    auto reader = response();
+    ASSERT(m_job->status.type == error::OK || m_job->received != 0, m_job->status);
+    return m_ticket << reader;
+  }
+
+private:
+  const detail::job *m_job;
+  Tk m_ticket;
+};
+
+//! \brief Runs the requests of several buses in parallel
+//! \details
+//!   Each bus is driven by its own worker thread, so that the duration of a control cycle is the one of the slowest bus
+//!   rather than the sum of every bus. The control thread submits requests to a bus through a single-producer
+//!   single-consumer ring of jobs: the instruction packet is serialized into the job by the control thread, and the
+//!   worker thread sends it and stores the status packets in the job. The tickets are run by the control thread once
+//!   the completion of the cycle has been reached.
+//!
+//!   A bus must be an output functor and an input functor which sets a flag read by 'timed_out' (and reset by 'clear')
+//!   when no byte arrives in time, like 'serial_bus' and 'simulator'. If it has a member function 'flush', it is called
+//!   after each instruction packet. Memory is only allocated by the constructor.
+//!
+//!   Idle workers spin for a short while before sleeping on a condition variable, which the control thread only
+//!   notifies when the worker is asleep.
+//! \tparam Bus Type of the buses
+//! \tparam Depth Number of jobs a bus can hold
+template <typename Bus, std::size_t Depth = 32> class executor {
+  static_assert(Depth > 0, "An executor must be able to store at least one job per bus");
+
+  struct lane {
+    explicit lane(Bus &&b) : bus{std::move(b)}, head{0}, tail{0}, sleeping{false} {}
+
+    Bus bus;
+    detail::job jobs[Depth];
+    executor_statistics statistics;
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+
+    // Written by the control thread only
+    std::atomic<std::size_t> head;
+    char head_padding[64];
+
+    // Written by the worker thread only
+    std::atomic<std::size_t> tail;
+    std::atomic<bool> sleeping;
+    char tail_padding[64];
+  };
+
+public:
+  //! \brief Completion barrier of a control cycle
+  //! \details
+  //!   The position of the ring of every bus is copied when the cycle is closed, so the barrier does not wait for the
+  //!   requests submitted afterwards. The copy is held by a slot of the executor, which is reused after 'Depth' further
+  //!   commits.
+  class completion {
+  public:
+    //! \brief Indicates whether every job of the cycle has been executed
+    bool ready() const {
+      for (std::size_t i = 0; i < m_executor->m_lanes.size(); ++i) {
+        if (m_executor->m_lanes[i]->tail.load(std::memory_order_acquire) < m_heads[i])
+          return false;
+      }
+      return true;
+    }
+
+    //! \brief Wait until every job of the cycle has been executed
+    void wait() const {
+      while (!ready())
+        std::this_thread::yield();
+    }
+
+  private:
+    friend class executor;
+    completion(const executor &ex, const std::size_t *heads) : m_executor{&ex}, m_heads{heads} {}
+
+    const executor *m_executor;
+    const std::size_t *m_heads;
+  };
+
+  //! \brief Number of iterations an idle worker spins for before sleeping
+  constexpr static unsigned spin_count = 1024;
+
+  //! \brief Take ownership of the buses and start a worker thread for each of them
+  //! \param buses Buses to drive
+  explicit executor(std::vector<Bus> buses) : m_commits(buses.size() * Depth), m_cycle{0}, m_stop{false} {
+    m_lanes.reserve(buses.size());
+    for (auto &bus : buses)
+      m_lanes.emplace_back(new lane{std::move(bus)});
+    for (auto &l : m_lanes)
+      l->worker = std::thread{&executor::run, this, std::ref(*l)};
+  }
+
+  executor(const executor &) = delete;
+  executor &operator=(const executor &) = delete;
+
+  //! \brief Stop the worker threads once their jobs have been executed
+  ~executor() {
+    m_stop.store(true);
+    for (auto &l : m_lanes) {
+      {
+        std::lock_guard<std::mutex> lock{l->mutex};
+        l->wake.notify_one();
+      }
+      l->worker.join();
+    }
+  }
+
+  //! \brief Number of buses
+  std::size_t size() const { return m_lanes.size(); }
+
+  //! \brief Queue a request on a bus
+  //! \details
+  //!   The instruction packet is serialized immediately, and the worker starts sending it as soon as possible. If the
+  //!   ring of the bus is full, the control thread waits for the oldest job to be executed.
+  //! \param index Index of the bus
+  //! \param request Request to send
+  //! \return A handle on the result of the request
+  template <typename R>
+  auto submit(std::size_t index, R &&request) -> pending<decltype(request >> std::declval<detail::job_writer &>())> {
+    auto &l = *m_lanes[index];
+    auto head = l.head.load(std::memory_order_relaxed);
+    while (head - l.tail.load(std::memory_order_acquire) == Depth)
+      std::this_thread::yield();
+
+    auto &j = l.jobs[head % Depth];
+    j.packet_size = 0;
+    j.response_size = 0;
+    j.status = error::OK;
+
+    detail::job_writer writer{&j, false};
+    auto tk = request >> writer;
+    using ticket_t = decltype(tk);
+    j.responses = detail::response_count<ticket_t>::of(j.packet[sizeof detail::header]);
+    if (writer.overflow || j.responses > detail::job::max_responses) {
+      j.packet_size = 0;
+      j.responses = 0;
+      j.status = error::BAD_LENGTH;
+    }
+
+    l.head.store(head + 1, std::memory_order_seq_cst);
+    if (l.sleeping.load(std::memory_order_seq_cst)) {
+      std::lock_guard<std::mutex> lock{l.mutex};
+      l.wake.notify_one();
+    }
+
+    return pending<ticket_t>{j, tk};
+  }
+
+  //! \brief Close the current control cycle
+  //! \return A barrier reached once every request submitted so far has been executed
+  completion commit() {
+    auto heads = m_commits.data() + m_cycle++ % Depth * m_lanes.size();
+    for (std::size_t i = 0; i < m_lanes.size(); ++i)
+      heads[i] = m_lanes[i]->head.load(std::memory_order_relaxed);
+    return completion{*this, heads};
+  }
+
+  //! \brief Statistics of the jobs executed on a bus
+  //! \param index Index of the bus
+  const executor_statistics &statistics(std::size_t index) const { return m_lanes[index]->statistics; }
+
+private:
+  void run(lane &l) {
+    auto tail = l.tail.load(std::memory_order_relaxed);
+    for (;;) {
+      if (!await(l, tail))
+        return;
+
+      execute(l, l.jobs[tail % Depth]);
+      l.tail.store(++tail, std::memory_order_release);
+    }
+  }
+
+  bool await(lane &l, std::size_t tail) {
+    for (unsigned i = 0; i < spin_count; ++i) {
+      if (l.head.load(std::memory_order_acquire) != tail)
+        return true;
+      if (m_stop.load(std::memory_order_relaxed))
+        return false;
+      std::this_thread::yield();
+    }
+
+    std::unique_lock<std::mutex> lock{l.mutex};
+    l.sleeping.store(true, std::memory_order_seq_cst);
+    l.wake.wait(lock, [&]() { return l.head.load(std::memory_order_seq_cst) != tail || m_stop.load(); });
+    l.sleeping.store(false, std::memory_order_relaxed);
+    return l.head.load(std::memory_order_acquire) != tail;
+  }
+
+  static void execute(lane &l, detail::job &j) {
+    using clock = std::chrono::steady_clock;
+
+    if (j.status.type != error::OK)
+      return;
+
+    auto start = clock::now();
+    l.bus.clear();
+    for (std::size_t i = 0; i < j.packet_size; ++i)
+      l.bus(j.packet[i]);
+    detail::flush_output(l.bus, 0);
+
+    j.received = 0;
+    bool timed_out = false;
+    for (std::size_t i = 0; i < j.responses; ++i) {
+      l.bus.clear();
+      auto &status = j.statuses[i];
+      status = gather(l.bus, j);
+      if (status.type == error::OK)
+        ++j.received;
+      else if (j.status.type == error::OK)
+        j.status = status;
+      if (status.type == error::TIMEOUT) {
+        detail::count_error(error::TIMEOUT);
+        timed_out = true;
+      }
+    }
+    if (timed_out)
+      l.statistics.timeouts.fetch_add(1, std::memory_order_relaxed);
+
+    auto elapsed = static_cast<std::uint64_t>(std::chrono::nanoseconds{clock::now() - start}.count());
+    auto &stats = l.statistics;
+    stats.last_ns.store(elapsed, std::memory_order_relaxed);
+    if (elapsed > stats.max_ns.load(std::memory_order_relaxed))
+      stats.max_ns.store(elapsed, std::memory_order_relaxed);
+    stats.total_ns.fetch_add(elapsed, std::memory_order_relaxed);
+    stats.jobs.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // The header of the first packet received is not stored, since tickets expect a packet without header. The following
+  // packets are stored with their header, as tickets look for it themselves. A packet is only kept once it has been
+  // fully received, and the reception stops as soon as the bus times out.
+  static error gather(Bus &bus, detail::job &j) {
+    constexpr auto fields_size = sizeof(packet_id) + sizeof(detail::length_t);
+
+    sentry s;
+    upd::byte_t byte;
+    do {
+      byte = bus();
+      if (bus.timed_out())
+        return error::TIMEOUT;
+    } while (!s(byte));
+
+    upd::byte_t fields[fields_size];
+    for (auto &field : fields) {
+      field = bus();
+      if (bus.timed_out())
+        return error::TIMEOUT;
+    }
+
+    std::size_t length = fields[1] | fields[2] << 8u;
+    auto header_size = j.received != 0 ? sizeof detail::header : 0;
+    if (header_size + fields_size + length > sizeof j.response - j.response_size)
+      return error::BAD_LENGTH;
+
+    auto ptr = std::copy(detail::header, detail::header + header_size, j.response + j.response_size);
+    ptr = std::copy(fields, fields + fields_size, ptr);
+    for (auto end = ptr + length; ptr != end; ++ptr) {
+      *ptr = bus();
+      if (bus.timed_out())
+        return error::TIMEOUT;
+    }
+
+    j.response_size = ptr - j.response;
+    return error::OK;
+  }
+
+  std::vector<std::unique_ptr<lane>> m_lanes;
+  std::vector<std::size_t> m_commits;
+  std::size_t m_cycle;
+  std::atomic<bool> m_stop;
+};
+
+template <typename Bus, std::size_t Depth> constexpr unsigned executor<Bus, Depth>::spin_count;
+
+} // namespace v2
+} // namespace ldp
+
+#include "detail/undef.hpp" // IWYU pragma: keep
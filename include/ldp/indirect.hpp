@@ -0,0 +1,173 @@
+//! \file
+//! \brief Indirect addressing of scattered memory zones
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include <tl/expected.hpp>
+#include <upd/format.hpp>
+#include <upd/type.hpp>
+
+#include "control_table.hpp"
+#include "detail/sfinae.hpp"
+#include "detail/type_list.hpp"
+#include "memzone.hpp"
+#include "packet.hpp"
+#include "read.hpp"
+#include "request.hpp"
+#include "ticket.hpp"
+
+#include "detail/def.hpp"
+
+namespace ldp {
+inline namespace v2 {
+namespace detail {
+
+//! \brief Total size of the first 'N' memory zones of a pack
+template <std::size_t N, typename... Zones> struct prefix_size : std::integral_constant<std::size_t, 0> {};
+template <std::size_t N, typename Zone, typename... Zones>
+struct prefix_size<N, Zone, Zones...>
+    : std::integral_constant<std::size_t, N == 0 ? 0
+                                                 : sizeof(typename Zone::type) +
+                                                       prefix_size<(N == 0 ? 0 : N - 1), Zones...>::value> {};
+
+//! \brief Position of a memory zone in the indirect data region
+template <typename Zone, typename... Zones>
+using indirect_offset = prefix_size<index_of<Zone, Zones...>::value, Zones...>;
+
+} // namespace detail
+
+//! \brief Process the status packet following a read of the indirect data region
+//! \tparam Signed_Mode Signed integer convention of the received packet
+//! \tparam Zones Memory zones mapped in the indirect data region, in order
+template <upd::signed_mode Signed_Mode, typename... Zones> class indirect_read_ticket {
+public:
+  //! \brief Extract the values of the memory zones from a packet
+  //! \param ftor Functor which delivers a byte each time it is called
+  template <typename F, sfinae::require_input_ftor<F> = 0>
+  tl::expected<device_data<fields<Zones...>>, error> operator<<(F &&ftor) const {
+    upd::byte_t buf[detail::prefix_size<sizeof...(Zones), Zones...>::value];
+    auto maybe_id = read_headerless_packet(FWD(ftor), upd::signed_mode_h<Signed_Mode>{}, buf, buf + sizeof buf);
+
+    return maybe_id.map([&](packet_id id) -> device_data<fields<Zones...>> {
+      device_data<fields<Zones...>> retval;
+      retval.id = id;
+      retval.value = fields<Zones...>{detail::decode_value<Signed_Mode, typename Zones::type>(
+          buf + detail::indirect_offset<Zones, Zones...>::value)...};
+      return retval;
+    });
+  }
+
+  //! \copybrief operator<<
+  //! \param it Start of the packet
+  template <typename It, sfinae::require_is_iterator<It> = 0>
+  tl::expected<device_data<fields<Zones...>>, error> operator<<(It it) const {
+    return operator<<([&]() { return *it++; });
+  }
+};
+
+//! \brief Maps scattered memory zones into the contiguous indirect data region of a device
+//! \details
+//!   Each byte of the indirect data region mirrors the byte of the device memory whose address is stored in the
+//!   corresponding entry of the indirect address region. Once 'setup' has been sent, the memory zones are accessed
+//!   together with a single read or write instruction on the indirect data region.
+//! \tparam Address_Base Address of the first entry of the indirect address region
+//! \tparam Data_Base Address of the first byte of the indirect data region
+//! \tparam Capacity Number of entries of the indirect address region
+//! \tparam Zones Memory zones to map, in order
+template <address_t Address_Base, address_t Data_Base, std::size_t Capacity, typename... Zones> struct indirect_map {
+  //! \brief Number of bytes of the indirect data region in use
+  constexpr static std::size_t size = detail::prefix_size<sizeof...(Zones), Zones...>::value;
+
+  static_assert(size <= Capacity, "The memory zones do not fit in the indirect data region");
+
+  //! \brief Memory zone of the indirect data region in use
+  using data_zone = memzone<Data_Base, upd::byte_t[size]>;
+
+  //! \brief Request class of the write instruction configuring the indirect address region
+  template <upd::signed_mode Signed_Mode> using setup_t = raw_write_t<Signed_Mode, 2 * size>;
+
+  //! \brief Request class of the read instruction on the indirect data region
+  template <upd::signed_mode Signed_Mode>
+  using read_t = request<Signed_Mode, indirect_read_ticket<Signed_Mode, Zones...>, address_t, std::uint16_t>;
+
+  //! \brief Request class of the write instruction on the indirect data region
+  template <upd::signed_mode Signed_Mode> using write_t = raw_write_t<Signed_Mode, size>;
+
+  //! \brief Prepare the write instruction configuring the indirect address region
+  //! \details This request must be sent once, while the torque of the device is disabled.
+  //! \tparam Signed_Mode Signed integer representation of the packet
+  //! \param id Identifier of the target device
+  //! \return A request object that holds the necessary data for the write instruction
+  template <upd::signed_mode Signed_Mode>
+  static setup_t<Signed_Mode> setup(upd::signed_mode_h<Signed_Mode>, packet_id id) {
+    setup_t<Signed_Mode> retval{id, Address_Base};
+    auto ptr = retval.data();
+    int dummy[] = {(ptr = set_addresses<Signed_Mode, Zones>(ptr), 0)...};
+    static_cast<void>(dummy);
+    return retval;
+  }
+
+  //! \copybrief setup
+  //! \param id Identifier of the target device
+  //! \return A request object that holds the necessary data for the write instruction
+  static setup_t<upd::signed_mode::TWO_COMPLEMENT> setup(packet_id id) { return setup(upd::two_complement, id); }
+
+  //! \brief Prepare a read instruction fetching every memory zone at once
+  //! \tparam Signed_Mode Signed integer representation of the packet
+  //! \param id Identifier of the target device
+  //! \return A request object whose ticket extracts a 'device_data<fields<Zones...>>'
+  template <upd::signed_mode Signed_Mode>
+  static read_t<Signed_Mode> read(upd::signed_mode_h<Signed_Mode>, packet_id id) {
+    return read_t<Signed_Mode>{id, instruction::READ, Data_Base, static_cast<std::uint16_t>(size)};
+  }
+
+  //! \copybrief read
+  //! \param id Identifier of the target device
+  //! \return A request object whose ticket extracts a 'device_data<fields<Zones...>>'
+  static read_t<upd::signed_mode::TWO_COMPLEMENT> read(packet_id id) { return read(upd::two_complement, id); }
+
+  //! \brief Prepare a write instruction setting every memory zone at once
+  //! \tparam Signed_Mode Signed integer representation of the packet
+  //! \param id Identifier of the target device
+  //! \param values Values to write
+  //! \return A request object that holds the necessary data for the write instruction
+  template <upd::signed_mode Signed_Mode>
+  static write_t<Signed_Mode> write(upd::signed_mode_h<Signed_Mode>, packet_id id, const fields<Zones...> &values) {
+    write_t<Signed_Mode> retval{id, Data_Base};
+    int dummy[] = {(detail::encode_value<Signed_Mode>(values.template get<Zones>(),
+                                                      retval.data() + detail::indirect_offset<Zones, Zones...>::value),
+                    0)...};
+    static_cast<void>(dummy);
+    return retval;
+  }
+
+  //! \copybrief write
+  //! \param id Identifier of the target device
+  //! \param values Values to write
+  //! \return A request object that holds the necessary data for the write instruction
+  static write_t<upd::signed_mode::TWO_COMPLEMENT> write(packet_id id, const fields<Zones...> &values) {
+    return write(upd::two_complement, id, values);
+  }
+
+private:
+  template <upd::signed_mode Signed_Mode, typename Zone> static upd::byte_t *set_addresses(upd::byte_t *dest) {
+    for (std::size_t i = 0; i < sizeof(typename Zone::type); ++i, dest += sizeof(address_t))
+      detail::encode_value<Signed_Mode>(static_cast<address_t>(Zone::address + i), dest);
+    return dest;
+  }
+};
+
+//! \brief Indirect mapping using the first indirect regions of the DYNAMIXEL X-series devices
+//! \details
+//!   https://emanual.robotis.com/docs/en/dxl/x/xm430-w350/#indirect-address
+//! \tparam Zones Memory zones to map, in order
+template <typename... Zones> using x_series_indirect_map = indirect_map<168, 224, 28, Zones...>;
+
+} // namespace v2
+} // namespace ldp
+
+#include "detail/undef.hpp" // IWYU pragma: keep
@@ -0,0 +1,238 @@
+//! \file
+//! \brief Optional bus statistics
+//! \details
+//!   The statistics are only collected if 'LDP_ENABLE_INSTRUMENTATION' is defined to a non-zero value before any
+//!   header of the library is included. Otherwise, the hooks called by the library are empty and 'statistics' is not
+//!   defined.
+//!
+//!   Every translation unit of a program must agree on 'LDP_ENABLE_INSTRUMENTATION', since the inline functions of the
+//!   library differ otherwise. It should be defined for the whole build rather than in a source file, e.g. with the
+//!   CMake option 'LDP_ENABLE_INSTRUMENTATION', which adds it to the compile definitions of the library target.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "detail/packet.hpp"
+
+#ifndef LDP_ENABLE_INSTRUMENTATION
+#define LDP_ENABLE_INSTRUMENTATION 0
+#endif
+
+#if LDP_ENABLE_INSTRUMENTATION
+#include <atomic>
+#include <chrono>
+#include <initializer_list>
+#endif
+
+namespace ldp {
+inline namespace v2 {
+
+#if LDP_ENABLE_INSTRUMENTATION
+
+//! \brief Counter which can be read from another thread while being incremented
+using counter = std::atomic<std::uint32_t>;
+
+//! \brief Number of packets and bytes exchanged
+struct traffic {
+  counter packets;
+  counter bytes;
+};
+
+//! \brief Histogram of durations with buckets of exponentially growing width
+//! \details
+//!   The bucket 0 holds the durations under 2 microseconds, and the bucket 'i' holds the durations in
+//!   [2^i, 2^(i + 1)) microseconds. The last bucket also holds every longer duration.
+//! \tparam N Number of buckets
+template <std::size_t N> class latency_histogram {
+public:
+  //! \brief Number of buckets
+  constexpr static std::size_t bucket_count = N;
+
+  //! \brief Initialize every bucket to zero
+  latency_histogram() { reset(); }
+
+  //! \brief Add a duration to the histogram
+  void record(std::chrono::nanoseconds duration) {
+    auto us = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+    std::size_t bucket = 0;
+    while (us >>= 1u)
+      ++bucket;
+
+    m_buckets[bucket < N ? bucket : N - 1].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  //! \brief Number of durations recorded in a bucket
+  std::uint32_t count(std::size_t bucket) const { return m_buckets[bucket].load(std::memory_order_relaxed); }
+
+  //! \brief Upper bound of the durations of a bucket (excluded)
+  static std::chrono::microseconds upper_bound(std::size_t bucket) {
+    return std::chrono::microseconds{std::uint64_t{2} << bucket};
+  }
+
+  //! \brief Set every bucket to zero
+  void reset() {
+    for (auto &bucket : m_buckets)
+      bucket.store(0, std::memory_order_relaxed);
+  }
+
+private:
+  counter m_buckets[N];
+};
+
+//! \brief Statistics of every bus handled by the library
+//! \details
+//!   The counters are incremented with relaxed atomic operations, so they can be read at any time from another thread
+//!   without synchronizing with the control loop. Two counters read one after the other are not necessarily
+//!   consistent with each other.
+struct bus_statistics {
+  //! \brief Number of values of 'error::type_t' which are counted
+  constexpr static std::size_t error_type_count = 16;
+
+  //! \brief Instruction packets sent, indexed by instruction
+  traffic sent_by_instruction[256];
+
+  //! \brief Instruction packets sent, indexed by device identifier
+  traffic sent_by_device[256];
+
+  //! \brief Status packets received, indexed by device identifier
+  traffic received_by_device[256];
+
+  //! \brief Failed receptions, indexed by 'error::type_t'
+  //! \details The bucket 'error::OK' counts the unknown error codes reported by devices.
+  counter errors[error_type_count];
+
+  //! \brief Status packets whose alert flag was set
+  counter alerts;
+
+  //! \brief Stuffing bytes sent and received
+  counter stuffing_bytes;
+
+  //! \brief Number of headers found after skipping bytes which do not belong to them
+  //! \details
+  //!   A packet rejected by 'parser' is not counted by itself: its bytes are skipped in the search for the next header,
+  //!   which is counted then.
+  counter resyncs;
+
+  //! \brief Time elapsed between sending a request and receiving its response
+  latency_histogram<24> latency;
+
+  //! \brief Initialize every statistic to zero
+  bus_statistics() { reset(); }
+
+  bus_statistics(const bus_statistics &) = delete;
+  bus_statistics &operator=(const bus_statistics &) = delete;
+
+  //! \brief Set every statistic to zero
+  void reset() {
+    for (auto *table : {sent_by_instruction, sent_by_device, received_by_device}) {
+      for (std::size_t i = 0; i < 256; ++i) {
+        table[i].packets.store(0, std::memory_order_relaxed);
+        table[i].bytes.store(0, std::memory_order_relaxed);
+      }
+    }
+    for (auto &count : errors)
+      count.store(0, std::memory_order_relaxed);
+    alerts.store(0, std::memory_order_relaxed);
+    stuffing_bytes.store(0, std::memory_order_relaxed);
+    resyncs.store(0, std::memory_order_relaxed);
+    latency.reset();
+  }
+};
+
+//! \brief Statistics collected by the library
+inline bus_statistics &statistics() {
+  static bus_statistics retval;
+  return retval;
+}
+
+namespace detail {
+
+//! \brief Number of 'uncounted_scope' alive in the calling thread
+inline unsigned &uncounted_depth() {
+  static thread_local unsigned retval = 0;
+  return retval;
+}
+
+//! \brief Scope in which the calling thread does not update 'statistics'
+//! \details
+//!   This is meant for the packets which do not travel on a bus of the host, such as the ones the simulated devices of
+//!   'simulator' parse and send.
+class uncounted_scope {
+public:
+  uncounted_scope() { ++uncounted_depth(); }
+  ~uncounted_scope() { --uncounted_depth(); }
+
+  uncounted_scope(const uncounted_scope &) = delete;
+  uncounted_scope &operator=(const uncounted_scope &) = delete;
+};
+
+inline bool counted() { return uncounted_depth() == 0; }
+
+inline void add(counter &c, std::size_t n) { c.fetch_add(static_cast<std::uint32_t>(n), std::memory_order_relaxed); }
+
+inline void count_sent(std::uint8_t id, instruction_t ins, std::size_t size, std::size_t stuffing) {
+  if (!counted())
+    return;
+
+  auto &stats = statistics();
+  add(stats.sent_by_instruction[ins].packets, 1);
+  add(stats.sent_by_instruction[ins].bytes, size);
+  add(stats.sent_by_device[id].packets, 1);
+  add(stats.sent_by_device[id].bytes, size);
+  if (stuffing != 0)
+    add(stats.stuffing_bytes, stuffing);
+}
+
+inline void count_received(std::uint8_t id, std::size_t size, std::size_t stuffing, error_t type, bool alert) {
+  if (!counted())
+    return;
+
+  auto &stats = statistics();
+  add(stats.received_by_device[id].packets, 1);
+  add(stats.received_by_device[id].bytes, size);
+  if (stuffing != 0)
+    add(stats.stuffing_bytes, stuffing);
+  if (type != 0)
+    add(stats.errors[type < bus_statistics::error_type_count ? type : 0], 1);
+  if (alert)
+    add(stats.alerts, 1);
+}
+
+inline void count_error(error_t type) {
+  if (counted())
+    add(statistics().errors[type < bus_statistics::error_type_count ? type : 0], 1);
+}
+
+inline void count_header_search(std::size_t read) {
+  if (counted() && read != sizeof header)
+    add(statistics().resyncs, 1);
+}
+
+inline void record_latency(std::chrono::nanoseconds duration) {
+  if (counted())
+    statistics().latency.record(duration);
+}
+
+} // namespace detail
+
+#else
+
+namespace detail {
+
+struct uncounted_scope {
+  uncounted_scope() {}
+};
+
+inline void count_sent(std::uint8_t, instruction_t, std::size_t, std::size_t) {}
+inline void count_received(std::uint8_t, std::size_t, std::size_t, error_t, bool) {}
+inline void count_error(error_t) {}
+inline void count_header_search(std::size_t) {}
+
+} // namespace detail
+
+#endif
+
+} // namespace v2
+} // namespace ldp
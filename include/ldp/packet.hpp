@@ -3,7 +3,9 @@
 #pragma once
 
 #include <algorithm>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <iterator>
 
 #include <tl/expected.hpp>
@@ -11,10 +13,12 @@
 #include <upd/tuple.hpp>
 #include <upd/type.hpp>
 
-#include "detail/def.hpp"
 #include "detail/packet.hpp"
+#include "instrumentation.hpp"
 #include "sentry.hpp"
 
+#include "detail/def.hpp"
+
 namespace ldp {
 inline namespace v2 {
 namespace detail {
@@ -23,6 +27,12 @@ template <typename It> length_t calculate_length(It begin, It end) {
   return std::distance(begin, end) + std::count_if(begin, end, stuffing_sentry{}) + sizeof(instruction_t) +
          sizeof(crc_t);
 }
+
+//! \brief Find the next byte which may need to be followed by a stuffing byte
+//! \return A pointer to the byte, or a null pointer if there is none (the sequence may be empty)
+inline const upd::byte_t *find_stuffing_byte(const upd::byte_t *begin, const upd::byte_t *end) {
+  return begin != end ? static_cast<const upd::byte_t *>(std::memchr(begin, stuffing_byte, end - begin)) : nullptr;
+}
 } // namespace detail
 
 //! \brief Type for the field 'Packet ID' in packets
@@ -67,13 +77,35 @@ struct error {
     ACCESS = 0x7,
     NOT_STATUS,
     BAD_LENGTH,
-    RECEIVED_BAD_CRC
+    RECEIVED_BAD_CRC,
+    TIMEOUT
   };
 
   type_t type;
   bool alert;
 
-  error(int type, int alert = false) : type{static_cast<type_t>(type)}, alert(alert) {}
+  error(int type = OK, int alert = false) : type{static_cast<type_t>(type)}, alert(alert) {}
+};
+
+//! \brief View on the content of a received packet
+//! \details
+//!   The header, the byte stuffing and the CRC have already been processed. For status packets, the field 'Error' is
+//!   extracted from the parameters.
+struct frame {
+  //! \brief Value of the field 'Packet ID'
+  packet_id id;
+
+  //! \brief Value of the field 'Instruction'
+  instruction ins;
+
+  //! \brief Value of the field 'Error' (always error::OK for instruction packets)
+  error err;
+
+  //! \brief Values of the field 'Param'
+  const upd::byte_t *parameters;
+
+  //! \brief Number of bytes in the field 'Param'
+  std::size_t size;
 };
 
 //! \brief Write a packet using the provided output functor
@@ -87,8 +119,8 @@ void write_packet(F &&dest_ftor, upd::signed_mode_h<Signed_Mode> signed_mode, pa
                   It parameters_begin, It parameters_end) {
   using namespace detail;
 
-  auto packet = upd::make_tuple(upd::little_endian, signed_mode, header, id,
-                                calculate_length(parameters_begin, parameters_end), static_cast<instruction_t>(ins));
+  auto length = calculate_length(parameters_begin, parameters_end);
+  auto packet = upd::make_tuple(upd::little_endian, signed_mode, header, id, length, static_cast<instruction_t>(ins));
   crc_t crc = 0;
 
   auto write = [&](upd::byte_t byte) {
@@ -109,8 +141,197 @@ void write_packet(F &&dest_ftor, upd::signed_mode_h<Signed_Mode> signed_mode, pa
 
   for (auto byte : upd::make_tuple(upd::little_endian, signed_mode, crc))
     dest_ftor(byte);
+
+  count_sent(id, static_cast<instruction_t>(ins), sizeof header + sizeof(packet_id) + sizeof(length_t) + length,
+             length - sizeof(instruction_t) - sizeof(crc_t) - std::distance(parameters_begin, parameters_end));
+}
+
+//! \brief Write a packet into a contiguous buffer
+//! \details
+//!   The parameters are copied in blocks between the positions where a stuffing byte must be inserted, the field
+//!   'Length' is set afterwards and the CRC is computed over the finished block.
+//! \param buf Start of the buffer to write on
+//! \param capacity Size of the buffer
+//! \param signed_mode Signed number representation in the packet
+//! \param id Value of the field 'Packet ID'
+//! \param ins Value of the field 'Instruction'
+//! \param parameters_begin, parameters_end Values of the field 'Param'
+//! \return the number of bytes written, or zero if the buffer is too small to hold the packet
+template <upd::signed_mode Signed_Mode>
+std::size_t write_packet(upd::byte_t *buf, std::size_t capacity, upd::signed_mode_h<Signed_Mode> signed_mode,
+                         packet_id id, instruction ins, const upd::byte_t *parameters_begin,
+                         const upd::byte_t *parameters_end) {
+  using namespace detail;
+
+  constexpr auto fields_size = sizeof header + sizeof(packet_id) + sizeof(length_t) + sizeof(instruction_t);
+  auto parameters_size = static_cast<std::size_t>(parameters_end - parameters_begin);
+  if (capacity < fields_size + parameters_size + sizeof(crc_t))
+    return 0;
+
+  auto ptr = buf + fields_size, end = buf + capacity - sizeof(crc_t);
+  auto block_begin = parameters_begin, it = parameters_begin;
+  while (auto found = find_stuffing_byte(it, parameters_end)) {
+    it = found + 1;
+    if (found - parameters_begin < 2 || found[-1] != 0xff || found[-2] != 0xff)
+      continue;
+    if (end - ptr < parameters_end - block_begin + 1)
+      return 0;
+    ptr = std::copy(block_begin, found, ptr);
+    *ptr++ = stuffing_byte;
+    block_begin = found;
+  }
+  ptr = std::copy(block_begin, parameters_end, ptr);
+
+  auto length = static_cast<length_t>(ptr - buf - fields_size + sizeof(instruction_t) + sizeof(crc_t));
+  auto fields = upd::make_tuple(upd::little_endian, signed_mode, header, id, length, static_cast<instruction_t>(ins));
+  std::copy(fields.begin(), fields.end(), buf);
+
+  crc_t crc = 0;
+  advance_crc(crc, buf, ptr);
+  for (auto byte : upd::make_tuple(upd::little_endian, signed_mode, crc))
+    *ptr++ = byte;
+
+  count_sent(id, static_cast<instruction_t>(ins), ptr - buf,
+             (ptr - buf) - fields_size - parameters_size - sizeof(crc_t));
+  return ptr - buf;
 }
 
+//! \brief Contiguous part of a packet
+struct packet_segment {
+  //! \brief Start of the part
+  const upd::byte_t *data;
+
+  //! \brief Number of bytes of the part
+  std::size_t size;
+};
+
+//! \brief Storage for the bytes of a packet which are not parameters
+//! \details The segments made by 'write_packet' refer to it, so it must outlive them.
+struct packet_envelope {
+  //! \brief Fields 'Header', 'Packet ID', 'Length' and 'Instruction'
+  upd::byte_t fields[sizeof detail::header + sizeof(packet_id) + sizeof(detail::length_t) +
+                     sizeof(detail::instruction_t)];
+
+  //! \brief Field 'CRC'
+  upd::byte_t crc[sizeof(detail::crc_t)];
+};
+
+//! \brief Describe a packet as a list of segments referring to its parameters in place
+//! \details
+//!   The parameters are not copied: they are split where a stuffing byte must be inserted, and two consecutive
+//!   segments overlap on the byte 0xfd which is sent twice. The other fields are written into the envelope. The
+//!   segments can be passed to 'writev' or to a DMA descriptor chain.
+//! \param segments Array receiving the segments
+//! \param capacity Size of the array
+//! \param envelope Storage for the fields which are not parameters
+//! \param signed_mode Signed number representation in the packet
+//! \param id Value of the field 'Packet ID'
+//! \param ins Value of the field 'Instruction'
+//! \param parameters_begin, parameters_end Values of the field 'Param'
+//! \return the number of segments, or zero if the array is too small to hold them
+template <upd::signed_mode Signed_Mode>
+std::size_t write_packet(packet_segment *segments, std::size_t capacity, packet_envelope &envelope,
+                         upd::signed_mode_h<Signed_Mode> signed_mode, packet_id id, instruction ins,
+                         const upd::byte_t *parameters_begin, const upd::byte_t *parameters_end) {
+  using namespace detail;
+
+  if (capacity < 2)
+    return 0;
+
+  auto out = segments, last = segments + capacity - 1;
+  *out++ = packet_segment{envelope.fields, sizeof envelope.fields};
+
+  std::size_t stuffing = 0;
+  auto block_begin = parameters_begin, it = parameters_begin;
+  while (auto found = find_stuffing_byte(it, parameters_end)) {
+    it = found + 1;
+    if (found - parameters_begin < 2 || found[-1] != 0xff || found[-2] != 0xff)
+      continue;
+    if (out == last)
+      return 0;
+    *out++ = packet_segment{block_begin, static_cast<std::size_t>(it - block_begin)};
+    block_begin = found;
+    ++stuffing;
+  }
+  if (block_begin != parameters_end) {
+    if (out == last)
+      return 0;
+    *out++ = packet_segment{block_begin, static_cast<std::size_t>(parameters_end - block_begin)};
+  }
+
+  auto parameters_size = static_cast<std::size_t>(parameters_end - parameters_begin);
+  auto length = static_cast<length_t>(parameters_size + stuffing + sizeof(instruction_t) + sizeof(crc_t));
+  auto fields = upd::make_tuple(upd::little_endian, signed_mode, header, id, length, static_cast<instruction_t>(ins));
+  std::copy(fields.begin(), fields.end(), envelope.fields);
+
+  crc_t crc = 0;
+  for (auto segment = segments; segment != out; ++segment)
+    advance_crc(crc, segment->data, segment->data + segment->size);
+  auto crc_field = upd::make_tuple(upd::little_endian, signed_mode, crc);
+  std::copy(crc_field.begin(), crc_field.end(), envelope.crc);
+  *out++ = packet_segment{envelope.crc, sizeof envelope.crc};
+
+  count_sent(id, static_cast<instruction_t>(ins), sizeof envelope.fields + length - sizeof(instruction_t), stuffing);
+  return out - segments;
+}
+
+namespace detail {
+
+//! \brief Information about a received packet gathered for the statistics
+struct packet_trace {
+  packet_id id;
+  std::size_t size;
+  std::size_t stuffing;
+};
+
+//! \copydoc ldp::read_headerless_packet
+//! \param trace Receives the identifier, the size and the number of stuffing bytes of the packet
+template <typename F, upd::signed_mode Signed_Mode, typename It>
+tl::expected<packet_id, error> read_headerless_packet(F &&src_ftor, upd::signed_mode_h<Signed_Mode> signed_mode,
+                                                      It parameters_begin, It parameters_end, packet_trace &trace) {
+  auto metadata = upd::make_tuple<packet_id, length_t, instruction_t, error_t>(upd::little_endian, signed_mode);
+  crc_t crc = 0;
+  advance_crc(crc, header);
+
+  auto read = [&]() {
+    auto byte = src_ftor();
+    advance_crc(crc, byte);
+    ++trace.size;
+    return byte;
+  };
+
+  for (auto &byte : metadata)
+    byte = read();
+  auto id = upd::get<0>(metadata);
+  auto length = upd::get<1>(metadata) - sizeof(instruction_t) - sizeof(crc_t) - sizeof(error_t);
+  auto ins = upd::get<2>(metadata);
+  auto err = upd::get<3>(metadata);
+  trace.id = id;
+
+  ASSERT(ins == status_byte, error::NOT_STATUS);
+
+  stuffing_sentry s;
+  for (; length != 0 && parameters_begin != parameters_end; ++parameters_begin, --length) {
+    auto byte = read();
+    if (s(byte) && length != 1) {
+      --length;
+      ++trace.stuffing;
+      read();
+    }
+    *parameters_begin = byte;
+  }
+  ASSERT(length == 0 && parameters_begin == parameters_end, error::BAD_LENGTH);
+
+  trace.size += sizeof(crc_t);
+  for (auto byte : upd::make_tuple(upd::little_endian, signed_mode, crc))
+    ASSERT(byte == src_ftor(), error::RECEIVED_BAD_CRC);
+  ASSERT(err == static_cast<error_t>(error::OK), (error{err & ~alert_bm, err & alert_bm}));
+
+  return id;
+}
+
+} // namespace detail
+
 //! \brief Read a packet content (without header) from an input functor
 //! \param src_ftor functor called each time a new byte of the packet must be read
 //! \param signed_mode signed number representation in the packet
@@ -124,9 +345,35 @@ void write_packet(F &&dest_ftor, upd::signed_mode_h<Signed_Mode> signed_mode, pa
 template <typename F, upd::signed_mode Signed_Mode, typename It>
 tl::expected<packet_id, error> read_headerless_packet(F &&src_ftor, upd::signed_mode_h<Signed_Mode> signed_mode,
                                                       It parameters_begin, It parameters_end) {
+  detail::packet_trace trace{0, sizeof detail::header, 0};
+  auto retval = detail::read_headerless_packet(FWD(src_ftor), signed_mode, parameters_begin, parameters_end, trace);
+  detail::count_received(trace.id, trace.size, trace.stuffing, retval ? error::OK : retval.error().type,
+                         !retval && retval.error().alert);
+  return retval;
+}
+
+//! \brief Read the content (without header) of a status packet answering a fast sync read instruction
+//! \details
+//!   Every device appends a block made of its error field, its identifier, its data and the CRC of the packet up to
+//!   that point. The last CRC is the one of the whole packet. Byte stuffing is removed over the whole parameter field,
+//!   including across block boundaries.
+//! \param src_ftor functor called each time a new byte of the packet must be read
+//! \param signed_mode signed number representation in the packet
+//! \param ids Array receiving the identifiers of the devices, in order of response
+//! \param errors Array receiving the status of each device block (a block with an incorrect CRC is marked as
+//!   error::RECEIVED_BAD_CRC)
+//! \param count Number of device blocks in the packet
+//! \param data_begin, data_end Range to write the data of every device on (its size must be a multiple of 'count')
+//! \return the number of device blocks successfully read, otherwise :
+//!   - error::NOT_STATUS if the packet instruction field does not denote a status packet
+//!   - error::BAD_LENGTH if the packet length does not perfectly fit the provided range
+template <typename F, upd::signed_mode Signed_Mode, typename It>
+tl::expected<std::size_t, error>
+read_headerless_fast_sync_packet(F &&src_ftor, upd::signed_mode_h<Signed_Mode> signed_mode, packet_id *ids,
+                                 error *errors, std::size_t count, It data_begin, It data_end) {
   using namespace detail;
 
-  auto metadata = upd::make_tuple<packet_id, length_t, instruction_t, error_t>(upd::little_endian, signed_mode);
+  auto metadata = upd::make_tuple<packet_id, length_t, instruction_t>(upd::little_endian, signed_mode);
   crc_t crc = 0;
   advance_crc(crc, header);
 
@@ -138,27 +385,58 @@ tl::expected<packet_id, error> read_headerless_packet(F &&src_ftor, upd::signed_
 
   for (auto &byte : metadata)
     byte = read();
-  auto id = upd::get<0>(metadata);
-  auto length = upd::get<1>(metadata) - sizeof(instruction_t) - sizeof(crc_t) - sizeof(error_t);
+  std::size_t length = upd::get<1>(metadata);
   auto ins = upd::get<2>(metadata);
-  auto err = upd::get<3>(metadata);
 
   ASSERT(ins == status_byte, error::NOT_STATUS);
+  ASSERT(count != 0 && length >= sizeof(instruction_t) + sizeof(crc_t), error::BAD_LENGTH);
+  length -= sizeof(instruction_t) + sizeof(crc_t);
 
   stuffing_sentry s;
-  for (; length != 0 && parameters_begin != parameters_end; ++parameters_begin, --length) {
+  bool overrun = false;
+  auto read_parameter = [&]() -> upd::byte_t {
+    if (length == 0) {
+      overrun = true;
+      return 0;
+    }
+    --length;
     auto byte = read();
-    if (s(byte))
+    if (s(byte) && length != 0) {
+      --length;
       read();
-    *parameters_begin = byte;
-  }
-  ASSERT(length == 0 && parameters_begin == parameters_end, error::BAD_LENGTH);
+    }
+    return byte;
+  };
 
-  for (auto byte : upd::make_tuple(upd::little_endian, signed_mode, crc))
-    ASSERT(byte == src_ftor(), error::RECEIVED_BAD_CRC);
-  ASSERT(err == static_cast<error_t>(error::OK), (error{err & ~alert_bm, err & alert_bm}));
+  auto data_size = static_cast<std::size_t>(std::distance(data_begin, data_end)) / count;
+  std::size_t successes = 0;
+  for (std::size_t i = 0; i < count; ++i) {
+    auto err = read_parameter();
+    ids[i] = read_parameter();
+    for (std::size_t j = 0; j < data_size; ++j)
+      *data_begin++ = read_parameter();
 
-  return id;
+    bool crc_ok = true;
+    if (i + 1 != count) {
+      for (auto byte : upd::make_tuple(upd::little_endian, signed_mode, crc))
+        crc_ok = read_parameter() == byte && crc_ok;
+    } else {
+      ASSERT(!overrun && length == 0 && data_begin == data_end, error::BAD_LENGTH);
+      for (auto byte : upd::make_tuple(upd::little_endian, signed_mode, crc))
+        crc_ok = src_ftor() == byte && crc_ok;
+    }
+
+    if (!crc_ok) {
+      errors[i] = error::RECEIVED_BAD_CRC;
+    } else if (err != static_cast<error_t>(error::OK)) {
+      errors[i] = error{err & ~alert_bm, err & alert_bm};
+    } else {
+      errors[i] = error::OK;
+      ++successes;
+    }
+  }
+
+  return successes;
 }
 
 } // namespace v2
@@ -0,0 +1,195 @@
+//! \file
+//! \brief Incremental packet parsing
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+
+#include <tl/expected.hpp>
+#include <upd/type.hpp>
+
+#include "detail/packet.hpp"
+#include "instrumentation.hpp"
+#include "packet.hpp"
+#include "sentry.hpp"
+
+namespace ldp {
+inline namespace v2 {
+
+//! \brief Extracts packets from a byte stream delivered in chunks of any size
+//! \details
+//!   The parser keeps its state between calls, so a packet may be split across any number of chunks. The bytes
+//!   following the header of the packet being parsed are kept, so that when the packet is malformed, the next header
+//!   is looked for from the byte following its header: the packets swallowed by a corrupted field 'Length' are not
+//!   lost.
+//! \tparam Capacity Maximum size of the field 'Param' of the packets (after byte stuffing removal)
+template <std::size_t Capacity> class parser {
+  enum class state { HEADER, ID, LENGTH_LOW, LENGTH_HIGH, INSTRUCTION, PARAMETERS, CRC_LOW, CRC_HIGH };
+
+  // Bytes of a packet following its header, byte stuffing included, before it is known to be malformed
+  constexpr static std::size_t raw_capacity =
+      sizeof(packet_id) + sizeof(detail::length_t) + sizeof(detail::instruction_t) + 2 * Capacity + 1 +
+      sizeof(detail::crc_t);
+
+public:
+  //! \brief Initialize the parser in the state of looking for a header
+  parser() { reset(); }
+
+  //! \brief Forget about the packet being parsed and look for the next header
+  void reset() {
+    restart();
+    m_replay_begin = m_replay_end = 0;
+  }
+
+  //! \brief Process one byte of the stream
+  //! \details
+  //!   The callback is called with a frame each time a packet is complete, or with one of the following errors :
+  //!     - error::BAD_LENGTH if the field 'Length' is inconsistent or the parameters exceed 'Capacity'
+  //!     - error::RECEIVED_BAD_CRC if the packet CRC is incorrect
+  //!   The frame refers to the internal buffer of the parser and is only valid during the call.
+  //! \param byte Byte of the stream
+  //! \param callback Functor called on a 'tl::expected<frame, error>'
+  template <typename F> void push(upd::byte_t byte, F &&callback) {
+    consume(byte, callback);
+    while (m_replay_begin != m_replay_end)
+      consume(m_raw[m_replay_begin++], callback);
+  }
+
+  //! \copybrief push
+  //! \param begin, end Chunk of the stream
+  //! \param callback Functor called on a 'tl::expected<frame, error>'
+  template <typename F> void push(const upd::byte_t *begin, const upd::byte_t *end, F &&callback) {
+    for (; begin != end; ++begin)
+      push(*begin, callback);
+  }
+
+private:
+  template <typename F> void consume(upd::byte_t byte, F &callback) {
+    using namespace detail;
+
+    if (m_state != state::HEADER)
+      m_raw[m_raw_size++] = byte;
+
+    switch (m_state) {
+    case state::HEADER:
+      ++m_searched;
+      if (m_header(byte)) {
+        detail::count_header_search(m_searched);
+        m_crc = 0;
+        advance_crc(m_crc, header);
+        m_state = state::ID;
+      }
+      return;
+    case state::ID:
+      m_id = byte;
+      m_state = state::LENGTH_LOW;
+      break;
+    case state::LENGTH_LOW:
+      m_length = byte;
+      m_state = state::LENGTH_HIGH;
+      break;
+    case state::LENGTH_HIGH:
+      m_length |= byte << 8u;
+      if (m_length < sizeof(instruction_t) + sizeof(crc_t))
+        return fail(error::BAD_LENGTH, callback);
+      m_packet_size = sizeof header + sizeof(packet_id) + sizeof(length_t) + m_length;
+      m_length -= sizeof(instruction_t) + sizeof(crc_t);
+      m_state = state::INSTRUCTION;
+      break;
+    case state::INSTRUCTION:
+      m_ins = byte;
+      m_size = 0;
+      m_stuffing = stuffing_sentry{};
+      m_skip = false;
+      m_state = m_length != 0 ? state::PARAMETERS : state::CRC_LOW;
+      break;
+    case state::PARAMETERS:
+      if (m_skip) {
+        m_skip = false;
+      } else {
+        if (m_size == Capacity)
+          return fail(error::BAD_LENGTH, callback);
+        m_buffer[m_size++] = byte;
+        m_skip = m_stuffing(byte);
+      }
+      if (--m_length == 0)
+        m_state = state::CRC_LOW;
+      break;
+    case state::CRC_LOW:
+      m_received_crc = byte;
+      m_state = state::CRC_HIGH;
+      return;
+    case state::CRC_HIGH:
+      m_received_crc |= byte << 8u;
+      return complete(callback);
+    }
+
+    advance_crc(m_crc, byte);
+  }
+
+  void restart() {
+    m_state = state::HEADER;
+    m_header = sentry{};
+    m_searched = 0;
+    m_raw_size = 0;
+  }
+
+  // The bytes of the rejected packet are parsed again from the one following its header, before the bytes which were
+  // waiting to be parsed again. The bytes of a packet are never stored past the position they are read from, so
+  // everything is moved within the same buffer.
+  template <typename F> void fail(error::type_t type, F &callback) {
+    detail::count_error(type);
+
+    auto waiting = m_replay_end - m_replay_begin;
+    std::memmove(m_raw + m_raw_size, m_raw + m_replay_begin, waiting);
+    m_replay_begin = 0;
+    m_replay_end = m_raw_size + waiting;
+    restart();
+
+    callback(tl::expected<frame, error>{tl::make_unexpected(error{type})});
+  }
+
+  template <typename F> void complete(F &callback) {
+    using namespace detail;
+
+    if (m_received_crc != m_crc)
+      return fail(error::RECEIVED_BAD_CRC, callback);
+
+    if (m_ins == status_byte && m_size == 0)
+      return fail(error::BAD_LENGTH, callback);
+
+    restart();
+    frame f{m_id, static_cast<instruction>(m_ins), error::OK, m_buffer, m_size};
+    if (m_ins == status_byte) {
+      f.err = error{m_buffer[0] & ~alert_bm, m_buffer[0] & alert_bm};
+      ++f.parameters;
+      --f.size;
+    }
+
+    auto stuffing = m_packet_size - sizeof header - sizeof(packet_id) - sizeof(length_t) - sizeof(instruction_t) -
+                    sizeof(crc_t) - m_size;
+    count_received(m_id, m_packet_size, stuffing, f.err.type, f.err.alert);
+    callback(tl::expected<frame, error>{f});
+  }
+
+  state m_state;
+  sentry m_header;
+  std::size_t m_searched;
+  stuffing_sentry m_stuffing;
+  bool m_skip;
+  packet_id m_id;
+  std::size_t m_length;
+  std::size_t m_packet_size;
+  detail::instruction_t m_ins;
+  detail::crc_t m_crc, m_received_crc;
+  std::size_t m_size;
+  upd::byte_t m_buffer[Capacity];
+  upd::byte_t m_raw[raw_capacity];
+  std::size_t m_raw_size, m_replay_begin, m_replay_end;
+};
+
+template <std::size_t Capacity> constexpr std::size_t parser<Capacity>::raw_capacity;
+
+} // namespace v2
+} // namespace ldp
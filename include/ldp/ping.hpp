@@ -1,6 +1,8 @@
 //! \file
 //! \brief Ping instruction utilities
 
+#pragma once
+
 #include <cstdint>
 
 #include <upd/format.hpp>
@@ -42,7 +44,7 @@ template <upd::signed_mode Signed_Mode> ping_t<Signed_Mode> ping(upd::signed_mod
 //! \copybrief ping
 //! \param id Identifier of the target device
 //! \return A request object that holds the necessary data for a ping instruction
-ping_t<upd::signed_mode::TWO_COMPLEMENT> ping(packet_id id) { return ping(upd::two_complement, id); }
+inline ping_t<upd::signed_mode::TWO_COMPLEMENT> ping(packet_id id) { return ping(upd::two_complement, id); }
 
 //! \copybrief ping
 //! \details
@@ -57,7 +59,7 @@ template <upd::signed_mode Signed_Mode> ping_t<Signed_Mode> ping(upd::signed_mod
 //! \details
 //!   The ping request will be broadcast to every devices in the bus it will be sent in
 //! \return A request object that holds the necessary data for a ping instruction
-ping_t<upd::signed_mode::TWO_COMPLEMENT> ping() { return ping(upd::two_complement, broadcast); }
+inline ping_t<upd::signed_mode::TWO_COMPLEMENT> ping() { return ping(upd::two_complement, broadcast); }
 
 } // namespace v2
 } // namespace ldp
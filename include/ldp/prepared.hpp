@@ -0,0 +1,253 @@
+//! \file
+//! \brief Requests serialized once and patched in place
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <upd/format.hpp>
+#include <upd/tuple.hpp>
+#include <upd/type.hpp>
+
+#include "detail/index_sequence.hpp"
+#include "detail/packet.hpp"
+#include "detail/sfinae.hpp"
+#include "memzone.hpp"
+#include "packet.hpp"
+#include "read.hpp"
+#include "request.hpp"
+#include "ticket.hpp"
+
+#include "detail/def.hpp"
+
+namespace ldp {
+inline namespace v2 {
+namespace detail {
+
+//! \brief Sum of the sizes of the given types
+constexpr std::size_t sizeof_sum() { return 0; }
+template <typename T, typename... Ts> constexpr std::size_t sizeof_sum(T *, Ts *...ptrs) {
+  return sizeof(T) + sizeof_sum(ptrs...);
+}
+
+} // namespace detail
+
+//! \brief Request whose packet is kept serialized between two sendings
+//! \details
+//!   The packet is serialized on construction. When a parameter is changed with 'set', only its bytes are overwritten
+//!   and the CRC is updated from the difference between the old and the new bytes, so the cost of an update is
+//!   proportional to the size of the parameter. If the packet holds a stuffing byte before or after the update, it is
+//!   entirely serialized again instead.
+//! \tparam Signed_Mode Signed integer representation of the packet
+//! \tparam Tk Ticket type returned when the request is sent
+//! \tparam Ts Type mapping of the field 'Param'
+template <upd::signed_mode Signed_Mode, typename Tk, typename... Ts>
+class prepared_request : public detail::request_base<prepared_request<Signed_Mode, Tk, Ts...>, Tk> {
+  static_assert(sizeof...(Ts) > 0, "A prepared request must have parameters");
+
+  using parameters_t = upd::tuple<upd::endianess::LITTLE, Signed_Mode, Ts...>;
+
+  constexpr static std::size_t fields_size = sizeof detail::header + sizeof(packet_id) + sizeof(detail::length_t) +
+                                             sizeof(detail::instruction_t);
+
+public:
+  //! \brief Serialize the packet
+  //! \param id Target device identifier
+  //! \param ins Instruction to the target device
+  //! \param parameters Parameters of the instruction
+  explicit prepared_request(packet_id id, instruction ins, const Ts &...parameters)
+      : m_id{id}, m_ins{ins}, m_parameters{parameters...} {
+    locate(detail::make_index_sequence<sizeof...(Ts)>{});
+    encode();
+
+    auto crc_end = fields_size + m_offsets[sizeof...(Ts)];
+    for (std::size_t i = 0; i < sizeof...(Ts); ++i)
+      m_shifts[i] = detail::crc_shift{crc_end - fields_size - m_offsets[i + 1]};
+  }
+
+  //! \brief Change the value of a parameter
+  //! \tparam I Index of the parameter
+  //! \param value New value of the parameter
+  template <std::size_t I, typename U> void set(const U &value) {
+    using namespace detail;
+    using T = typename std::tuple_element<I, std::tuple<Ts...>>::type;
+
+    auto bytes = upd::make_tuple(upd::little_endian, upd::signed_mode_h<Signed_Mode>{}, static_cast<const T &>(value));
+    auto first = m_offsets[I], last = m_offsets[I + 1];
+    auto field = m_parameters.begin() + first;
+
+    crc_t delta = 0;
+    auto src = bytes.begin();
+    for (auto ptr = field; ptr != m_parameters.begin() + last; ++ptr, ++src) {
+      advance_crc(delta, static_cast<upd::byte_t>(*ptr ^ *src));
+      *ptr = *src;
+    }
+
+    if (m_stuffed || needs_stuffing(first, last)) {
+      encode();
+      return;
+    }
+
+    std::copy(field, m_parameters.begin() + last, m_packet + fields_size + first);
+    m_crc ^= m_shifts[I](delta);
+    write_crc();
+  }
+
+  //! \brief Call a functor on each byte of the packet
+  //! \param ftor The functor to call
+  //! \return A ticket that can interpret the response from the target device
+  template <typename F, sfinae::require_output_ftor<F> = 0> Tk write(F &&ftor) const {
+    for (auto ptr = m_packet; ptr != m_packet + m_size; ++ptr)
+      ftor(*ptr);
+    return {};
+  }
+
+  //! \brief Serialized packet
+  const upd::byte_t *data() const { return m_packet; }
+
+  //! \brief Size of the serialized packet
+  std::size_t size() const { return m_size; }
+
+private:
+  constexpr static std::size_t parameters_size = detail::sizeof_sum(static_cast<Ts *>(nullptr)...);
+
+  //! \brief Maximum size of the packet, when a stuffing byte follows every three bytes of the parameters
+  constexpr static std::size_t capacity = fields_size + parameters_size + parameters_size / 3 + sizeof(detail::crc_t);
+
+  template <std::size_t... Is> void locate(detail::index_sequence<Is...>) {
+    std::size_t offsets[] = {static_cast<std::size_t>(upd::make_view<Is, 1>(m_parameters).begin() -
+                                                      m_parameters.begin())...,
+                             static_cast<std::size_t>(m_parameters.end() - m_parameters.begin())};
+    std::copy(offsets, offsets + sizeof...(Ts) + 1, m_offsets);
+  }
+
+  void encode() {
+    m_size = write_packet(m_packet, capacity, upd::signed_mode_h<Signed_Mode>{}, m_id, m_ins, m_parameters.begin(),
+                          m_parameters.end());
+    m_stuffed = m_size != fields_size + m_offsets[sizeof...(Ts)] + sizeof(detail::crc_t);
+    m_crc = m_packet[m_size - 2] | m_packet[m_size - 1] << 8u;
+  }
+
+  void write_crc() {
+    m_packet[m_size - 2] = m_crc & 0xff;
+    m_packet[m_size - 1] = m_crc >> 8u;
+  }
+
+  bool needs_stuffing(std::size_t first, std::size_t last) const {
+    auto begin = m_parameters.begin() + (first < 2 ? 0 : first - 2);
+    auto end = m_parameters.begin() + std::min(last + 2, m_offsets[sizeof...(Ts)]);
+    stuffing_sentry s;
+    for (auto ptr = begin; ptr != end; ++ptr) {
+      if (s(*ptr))
+        return true;
+    }
+    return false;
+  }
+
+  packet_id m_id;
+  instruction m_ins;
+  parameters_t m_parameters;
+  std::size_t m_offsets[sizeof...(Ts) + 1];
+  detail::crc_shift m_shifts[sizeof...(Ts)];
+  upd::byte_t m_packet[capacity];
+  std::size_t m_size;
+  detail::crc_t m_crc;
+  bool m_stuffed;
+};
+
+//! \brief Prepared request class for a write instruction
+//! \details The value is the parameter of index 1.
+//! \tparam Signed_Mode Signed integer representation of the packets involved in the request
+//! \tparam T Type of the value to be written
+template <upd::signed_mode Signed_Mode, typename T>
+using prepared_write_t = prepared_request<Signed_Mode, ticket<Signed_Mode, packet_id>, address_t, T>;
+
+//! \brief Serialize a write instruction packet to be updated in place
+//! \tparam Signed_Mode Signed integer representation of the packet
+//! \tparam Address Start of the memory zone to write on
+//! \tparam T Type associated with the memory zone
+//! \param id Identifier of the target device
+//! \param value Initial value to write
+//! \return A request object whose value can be changed with 'set<1>'
+template <upd::signed_mode Signed_Mode, address_t Address, typename T, typename U>
+prepared_write_t<Signed_Mode, T> prepare_write(upd::signed_mode_h<Signed_Mode>, packet_id id, memzone<Address, T>,
+                                               const U &value) {
+  return prepared_write_t<Signed_Mode, T>{id, instruction::WRITE, Address, static_cast<const T &>(value)};
+}
+
+//! \copybrief prepare_write
+//! \tparam Address Start of the memory zone to write on
+//! \tparam T Type associated with the memory zone
+//! \param id Identifier of the target device
+//! \param value Initial value to write
+//! \return A request object whose value can be changed with 'set<1>'
+template <address_t Address, typename T, typename U>
+prepared_write_t<upd::signed_mode::TWO_COMPLEMENT, T> prepare_write(packet_id id, memzone<Address, T>,
+                                                                    const U &value) {
+  return prepare_write(upd::two_complement, id, memzone<Address, T>{}, value);
+}
+
+namespace detail {
+
+//! \brief Make the type of a prepared request whose parameters are the element types of a 'std::tuple'
+template <upd::signed_mode Signed_Mode, typename Tk, typename Tuple> struct flat_prepared_request;
+template <upd::signed_mode Signed_Mode, typename Tk, typename... Ts>
+struct flat_prepared_request<Signed_Mode, Tk, std::tuple<Ts...>> {
+  using type = prepared_request<Signed_Mode, Tk, Ts...>;
+};
+
+//! \brief Parameters of the entry of a device in a sync write instruction
+template <typename T, typename U> std::tuple<packet_id, T> sync_write_entry(const device_data<U> &entry) {
+  return std::tuple<packet_id, T>{entry.id, static_cast<const T &>(entry.value)};
+}
+
+} // namespace detail
+
+//! \brief Prepared request class for a sync write instruction
+//! \details The value of the k-th device is the parameter of index '3 + 2 * k'.
+//! \tparam Signed_Mode Signed integer representation of the packets involved in the request
+//! \tparam T Type of the value to be written
+//! \tparam Us Types of the values of each device (only their number matters)
+template <upd::signed_mode Signed_Mode, typename T, typename... Us>
+using prepared_sync_write_t = typename detail::flat_prepared_request<
+    Signed_Mode, no_response,
+    decltype(std::tuple_cat(std::tuple<address_t, std::uint16_t>{},
+                            detail::sync_write_entry<T>(std::declval<device_data<Us>>())...))>::type;
+
+//! \brief Serialize a sync write instruction packet to be updated in place
+//! \tparam Signed_Mode Signed integer representation of the packet
+//! \tparam Address Start of the memory zone to write on
+//! \tparam T Type associated with the memory zone
+//! \param entries Identifier of each device and the initial value to write on it
+//! \return A request object whose value for the k-th device can be changed with 'set<3 + 2 * k>'
+template <upd::signed_mode Signed_Mode, address_t Address, typename T, typename... Us>
+prepared_sync_write_t<Signed_Mode, T, Us...> prepare_sync_write(upd::signed_mode_h<Signed_Mode>, memzone<Address, T>,
+                                                                const device_data<Us> &...entries) {
+  using request_t = prepared_sync_write_t<Signed_Mode, T, Us...>;
+  return detail::make_flat_request<request_t>(
+      broadcast, instruction::SYNC_WRITE,
+      std::tuple_cat(std::tuple<address_t, std::uint16_t>{Address, sizeof(T)},
+                     detail::sync_write_entry<T>(entries)...),
+      detail::make_index_sequence<2 + 2 * sizeof...(Us)>{});
+}
+
+//! \copybrief prepare_sync_write
+//! \tparam Address Start of the memory zone to write on
+//! \tparam T Type associated with the memory zone
+//! \param entries Identifier of each device and the initial value to write on it
+//! \return A request object whose value for the k-th device can be changed with 'set<3 + 2 * k>'
+template <address_t Address, typename T, typename... Us>
+prepared_sync_write_t<upd::signed_mode::TWO_COMPLEMENT, T, Us...>
+prepare_sync_write(memzone<Address, T>, const device_data<Us> &...entries) {
+  return prepare_sync_write(upd::two_complement, memzone<Address, T>{}, entries...);
+}
+
+} // namespace v2
+} // namespace ldp
+
+#include "detail/undef.hpp" // IWYU pragma: keep
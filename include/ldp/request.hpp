@@ -3,10 +3,14 @@
 
 #pragma once
 
+#include <cstddef>
+#include <tuple>
+
 #include <upd/format.hpp>
 #include <upd/tuple.hpp>
 #include <upd/type.hpp>
 
+#include "detail/index_sequence.hpp"
 #include "detail/sfinae.hpp"
 #include "packet.hpp"
 
@@ -67,6 +71,23 @@ private:
   upd::tuple<upd::endianess::LITTLE, Signed_Mode, Ts...> m_parameters;
 };
 
+namespace detail {
+
+//! \brief Make the type of a request object whose parameters are the element types of a 'std::tuple'
+template <upd::signed_mode Signed_Mode, typename Tk, typename Tuple> struct flat_request;
+template <upd::signed_mode Signed_Mode, typename Tk, typename... Ts>
+struct flat_request<Signed_Mode, Tk, std::tuple<Ts...>> {
+  using type = request<Signed_Mode, Tk, Ts...>;
+};
+
+//! \brief Make a request object whose parameters are the elements of a 'std::tuple'
+template <typename R, typename Tuple, std::size_t... Is>
+R make_flat_request(packet_id id, instruction ins, const Tuple &parameters, index_sequence<Is...>) {
+  return R{id, ins, std::get<Is>(parameters)...};
+}
+
+} // namespace detail
+
 } // namespace v2
 } // namespace ldp
 
@@ -0,0 +1,225 @@
+//! \file
+//! \brief Single-producer single-consumer byte ring
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+
+#include <upd/type.hpp>
+
+#ifndef LDP_RING_RELAX
+//! \brief Statement executed by 'byte_ring' functors while waiting for the other side
+//! \details
+//!   It does nothing by default, which suits a ring shared with an interrupt handler. When both sides are threads, it
+//!   can be defined to 'std::this_thread::yield()' so that a waiting thread does not hold its core.
+#define LDP_RING_RELAX()
+#endif // LDP_RING_RELAX
+
+namespace ldp {
+inline namespace v2 {
+
+//! \brief Contiguous byte sequence
+struct byte_span {
+  //! \brief Start of the sequence
+  upd::byte_t *data;
+
+  //! \brief Number of bytes of the sequence
+  std::size_t size;
+};
+
+//! \brief Region of a ring, made of two contiguous parts when it wraps around the end of the storage
+struct ring_region {
+  //! \brief Part of the region starting at the current position
+  byte_span first;
+
+  //! \brief Part of the region starting at the beginning of the storage (empty if the region does not wrap around)
+  byte_span second;
+
+  //! \brief Number of bytes of the region
+  std::size_t size() const { return first.size + second.size; }
+};
+
+//! \brief Byte ring shared by one producer and one consumer
+//! \details
+//!   Each side only writes its own index, so that every operation is wait-free. Both indices are aligned on separate
+//!   cache lines, along with the last value of the other index seen by their owner: a single byte operation only reads
+//!   the index of the other side again when the cached value does not allow it to complete. Before C++17, 'new' does
+//!   not honour an alignment larger than the one of 'std::max_align_t', so a ring allocated on the heap may share its
+//!   cache lines with other objects: it is better given static storage.
+//!
+//!   Bytes can be copied in and out in bulk ('push', 'pop'), or accessed in place through the free region and the
+//!   filled region ('write_region' and 'commit', 'read_region' and 'consume'), so that a DMA transfer can be made
+//!   directly from or into the ring.
+//!
+//!   An instance is both an output functor and an input functor, so it can be passed to 'request::operator>>' and
+//!   'ticket::operator<<'. Unlike the other operations, these functors wait for the other side when the ring is full or
+//!   empty (see 'LDP_RING_RELAX'). The input functor gives up after the number of attempts set by 'spin_limit': it then
+//!   returns 0 and sets 'timed_out', like 'serial_bus', so that the search for a packet which never comes ends. Until
+//!   'clear' is called, it returns 0 at once when the ring is empty.
+//! \tparam N Capacity of the ring (a power of two)
+template <std::size_t N> class byte_ring {
+  static_assert(N != 0 && (N & (N - 1)) == 0, "The capacity of a ring must be a power of two");
+
+public:
+  //! \brief Size of a cache line
+  constexpr static std::size_t cache_line = 64;
+
+  //! \brief Number of bytes the ring can hold
+  constexpr static std::size_t capacity = N;
+
+  //! \brief Make an empty ring
+  //! \param spin_limit Number of attempts of the input functor to remove a byte (0 to wait indefinitely)
+  explicit byte_ring(std::size_t spin_limit = 0)
+      : m_head{0}, m_tail_cache{0}, m_tail{0}, m_head_cache{0}, m_spin_limit{spin_limit}, m_timed_out{false} {}
+
+  byte_ring(const byte_ring &) = delete;
+  byte_ring &operator=(const byte_ring &) = delete;
+
+  //! \brief Append a byte (producer side)
+  //! \return Whether the ring had room for the byte
+  bool push(upd::byte_t byte) {
+    auto head = m_head.load(std::memory_order_relaxed);
+    if (head - m_tail_cache == N && head - (m_tail_cache = m_tail.load(std::memory_order_acquire)) == N)
+      return false;
+
+    m_buffer[head & (N - 1)] = byte;
+    m_head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  //! \brief Append as many bytes of a sequence as possible (producer side)
+  //! \param begin, end Sequence to append
+  //! \return The number of bytes appended
+  std::size_t push(const upd::byte_t *begin, const upd::byte_t *end) {
+    auto region = write_region();
+    auto count = std::min<std::size_t>(region.size(), end - begin);
+    auto first = std::min(count, region.first.size);
+    std::memcpy(region.first.data, begin, first);
+    std::memcpy(region.second.data, begin + first, count - first);
+    commit(count);
+    return count;
+  }
+
+  //! \brief Free region of the ring (producer side)
+  //! \details The bytes written in the region are handed to the consumer by 'commit'.
+  ring_region write_region() {
+    auto head = m_head.load(std::memory_order_relaxed);
+    m_tail_cache = m_tail.load(std::memory_order_acquire);
+    return region(head, N - (head - m_tail_cache));
+  }
+
+  //! \brief Hand the first bytes of the free region to the consumer (producer side)
+  //! \param count Number of bytes written at the start of the region returned by 'write_region'
+  void commit(std::size_t count) {
+    m_head.store(m_head.load(std::memory_order_relaxed) + count, std::memory_order_release);
+  }
+
+  //! \brief Remove the oldest byte (consumer side)
+  //! \param byte Receives the removed byte
+  //! \return Whether the ring held a byte
+  bool pop(upd::byte_t &byte) {
+    auto tail = m_tail.load(std::memory_order_relaxed);
+    if (tail == m_head_cache && tail == (m_head_cache = m_head.load(std::memory_order_acquire)))
+      return false;
+
+    byte = m_buffer[tail & (N - 1)];
+    m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  //! \brief Remove as many bytes as possible (consumer side)
+  //! \param buf Buffer receiving the removed bytes
+  //! \param size Capacity of 'buf'
+  //! \return The number of bytes removed
+  std::size_t pop(upd::byte_t *buf, std::size_t size) {
+    auto region = read_region();
+    auto count = std::min(region.size(), size);
+    auto first = std::min(count, region.first.size);
+    std::memcpy(buf, region.first.data, first);
+    std::memcpy(buf + first, region.second.data, count - first);
+    consume(count);
+    return count;
+  }
+
+  //! \brief Filled region of the ring (consumer side)
+  //! \details The bytes of the region are handed back to the producer by 'consume'.
+  ring_region read_region() {
+    auto tail = m_tail.load(std::memory_order_relaxed);
+    m_head_cache = m_head.load(std::memory_order_acquire);
+    return region(tail, m_head_cache - tail);
+  }
+
+  //! \brief Hand the first bytes of the filled region back to the producer (consumer side)
+  //! \param count Number of bytes read at the start of the region returned by 'read_region'
+  void consume(std::size_t count) {
+    m_tail.store(m_tail.load(std::memory_order_relaxed) + count, std::memory_order_release);
+  }
+
+  //! \brief Number of bytes in the ring
+  //! \details The value may be outdated as soon as it is returned if the other side is active.
+  std::size_t size() const { return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire); }
+
+  //! \brief Indicates whether the ring holds no byte
+  bool empty() const { return size() == 0; }
+
+  //! \brief Append a byte, waiting for room if the ring is full (producer side)
+  void operator()(upd::byte_t byte) {
+    while (!push(byte))
+      LDP_RING_RELAX();
+  }
+
+  //! \brief Remove the oldest byte, waiting for one if the ring is empty (consumer side)
+  //! \details If no byte arrives within 'spin_limit' attempts, 'timed_out' is set and 0 is returned.
+  upd::byte_t operator()() {
+    upd::byte_t retval;
+    for (std::size_t spins = 1; !pop(retval); ++spins) {
+      if (m_timed_out || spins == m_spin_limit) {
+        m_timed_out = true;
+        return 0;
+      }
+      LDP_RING_RELAX();
+    }
+
+    return retval;
+  }
+
+  //! \brief Indicates whether the input functor gave up waiting since the last call to 'clear' (consumer side)
+  bool timed_out() const { return m_timed_out; }
+
+  //! \brief Reset the timeout flag (consumer side)
+  void clear() { m_timed_out = false; }
+
+  //! \brief Number of attempts of the input functor to remove a byte (0 if it waits indefinitely)
+  std::size_t spin_limit() const { return m_spin_limit; }
+
+  //! \brief Set the number of attempts of the input functor to remove a byte (0 to wait indefinitely)
+  void spin_limit(std::size_t value) { m_spin_limit = value; }
+
+private:
+  ring_region region(std::size_t position, std::size_t size) {
+    auto offset = position & (N - 1);
+    auto first = std::min(size, N - offset);
+    return ring_region{byte_span{m_buffer + offset, first}, byte_span{m_buffer, size - first}};
+  }
+
+  // Written by the producer only
+  alignas(cache_line) std::atomic<std::size_t> m_head;
+  std::size_t m_tail_cache;
+
+  // Written by the consumer only
+  alignas(cache_line) std::atomic<std::size_t> m_tail;
+  std::size_t m_head_cache;
+  std::size_t m_spin_limit;
+  bool m_timed_out;
+
+  alignas(cache_line) upd::byte_t m_buffer[N];
+};
+
+template <std::size_t N> constexpr std::size_t byte_ring<N>::cache_line;
+template <std::size_t N> constexpr std::size_t byte_ring<N>::capacity;
+
+} // namespace v2
+} // namespace ldp
@@ -0,0 +1,109 @@
+//! \file
+//! \brief Dispatching of received packets to pending tickets
+
+#pragma once
+
+#include <cstddef>
+
+#include "packet.hpp"
+#include "ticket.hpp"
+
+namespace ldp {
+inline namespace v2 {
+
+//! \brief Outcome of the dispatching of a packet by a router
+enum class route_status {
+  //! \brief The packet has been passed to the oldest pending ticket of its device
+  DISPATCHED,
+  //! \brief No ticket was pending for the device and no response was expected from it
+  ORPHAN,
+  //! \brief No ticket was pending for the device but its last pending ticket has already been answered
+  DUPLICATE,
+  //! \brief The packet is not a status packet (e.g. the echo of an instruction packet on a half-duplex bus)
+  NOT_STATUS
+};
+
+//! \brief Result of 'router::dispatch'
+struct route_result {
+  //! \brief Whether the packet has been passed to a ticket
+  route_status status;
+
+  //! \brief Error returned by the ticket (always 'error::OK' if the packet has not been dispatched)
+  error err;
+};
+
+//! \brief Matches received packets with the tickets of the requests they answer
+//! \details
+//!   Tickets are stored in a table indexed by packet identifier, so that dispatching a packet is done in constant time.
+//!   Several requests may be sent to the same device before it answers: the tickets of a device are then answered in
+//!   the order they have been registered. No memory is allocated.
+//! \tparam Depth Maximum number of pending tickets per device
+template <std::size_t Depth = 1> class router {
+  static_assert(Depth > 0, "A router must be able to store at least one ticket per device");
+
+public:
+  //! \brief Number of identifiers a device can take ('broadcast' excluded)
+  constexpr static std::size_t id_count = 253;
+
+  //! \brief Initialize the router with no pending ticket
+  router() : m_entries{} {}
+
+  //! \brief Register a ticket waiting for a response from a device
+  //! \param id Identifier of the device
+  //! \param tk Ticket of the request sent to the device
+  //! \return Whether the ticket has been registered (false if the identifier is invalid or the queue is full)
+  bool expect(packet_id id, const ticket_with_hook &tk) {
+    if (id >= id_count || m_entries[id].count == Depth)
+      return false;
+
+    auto &entry = m_entries[id];
+    entry.tickets[(entry.first + entry.count++) % Depth] = tk;
+    entry.answered = false;
+    return true;
+  }
+
+  //! \brief Pass a packet to the oldest pending ticket of the device which sent it
+  //! \details Packets which are not status packets are left out, so they do not consume the ticket of their device.
+  //! \param f Packet received from a device
+  //! \return Whether the packet has been dispatched and the error returned by the ticket
+  route_result dispatch(const frame &f) {
+    if (f.ins != instruction::RETURN)
+      return {route_status::NOT_STATUS, error::OK};
+    if (f.id >= id_count)
+      return {route_status::ORPHAN, error::OK};
+
+    auto &entry = m_entries[f.id];
+    if (entry.count == 0)
+      return {entry.answered ? route_status::DUPLICATE : route_status::ORPHAN, error::OK};
+
+    auto tk = entry.tickets[entry.first];
+    entry.first = (entry.first + 1) % Depth;
+    entry.answered = --entry.count == 0;
+    return {route_status::DISPATCHED, tk(f)};
+  }
+
+  //! \brief Drop the pending tickets of a device
+  //! \details This is typically done when the device has not answered in time.
+  //! \param id Identifier of the device
+  void cancel(packet_id id) {
+    if (id < id_count)
+      m_entries[id] = entry_t{};
+  }
+
+  //! \brief Number of pending tickets of a device
+  std::size_t pending(packet_id id) const { return id < id_count ? m_entries[id].count : 0; }
+
+private:
+  struct entry_t {
+    ticket_with_hook tickets[Depth];
+    std::size_t first, count;
+    bool answered;
+
+    entry_t() : first{0}, count{0}, answered{false} {}
+  };
+
+  entry_t m_entries[id_count];
+};
+
+} // namespace v2
+} // namespace ldp
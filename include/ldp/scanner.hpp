@@ -0,0 +1,137 @@
+//! \file
+//! \brief Sequence detection in contiguous buffers
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <upd/type.hpp>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "detail/packet.hpp"
+#include "sentry.hpp"
+
+namespace ldp {
+inline namespace v2 {
+namespace detail {
+
+//! \brief Call a functor on the address of each occurrence of a byte value in a contiguous buffer, in order
+//! \details
+//!   The buffer is compared by blocks of 32 bytes with AVX2, 16 bytes with SSE2 or NEON, or with 'memchr'. The search
+//!   stops as soon as the functor returns 'false'.
+template <typename F> void for_each_occurrence(const upd::byte_t *begin, const upd::byte_t *end, upd::byte_t value,
+                                               F &&ftor) {
+  auto ptr = begin;
+
+#if defined(__AVX2__)
+  const auto pattern = _mm256_set1_epi8(static_cast<char>(value));
+  for (; end - ptr >= 32; ptr += 32) {
+    auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(ptr));
+    auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, pattern)));
+    for (; mask != 0; mask &= mask - 1) {
+      if (!ftor(ptr + __builtin_ctz(mask)))
+        return;
+    }
+  }
+#elif defined(__SSE2__)
+  const auto pattern = _mm_set1_epi8(static_cast<char>(value));
+  for (; end - ptr >= 16; ptr += 16) {
+    auto block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr));
+    auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, pattern)));
+    for (; mask != 0; mask &= mask - 1) {
+      if (!ftor(ptr + __builtin_ctz(mask)))
+        return;
+    }
+  }
+#elif defined(__ARM_NEON)
+  const auto pattern = vdupq_n_u8(value);
+  for (; end - ptr >= 16; ptr += 16) {
+    auto matches = vreinterpretq_u16_u8(vceqq_u8(vld1q_u8(ptr), pattern));
+    auto mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(matches, 4)), 0) & 0x8888888888888888ull;
+    for (; mask != 0; mask &= mask - 1) {
+      if (!ftor(ptr + __builtin_ctzll(mask) / 4))
+        return;
+    }
+  }
+#endif
+
+  while (auto found = static_cast<const upd::byte_t *>(std::memchr(ptr, value, end - ptr))) {
+    if (!ftor(found))
+      return;
+    ptr = found + 1;
+  }
+}
+
+} // namespace detail
+
+//! \brief Find the headers in a contiguous buffer
+//! \details
+//!   The result is the same as calling a 'sentry' object on every byte of the buffer and recording the positions at
+//!   which it returns 'true'. Candidates are located with a vectorized search and confirmed with a 'sentry' only when
+//!   they are preceded by other header bytes.
+//! \param begin, end Buffer to search in
+//! \param positions Array receiving the offsets of the last byte of each header
+//! \param capacity Size of the 'positions' array
+//! \return the number of offsets written to 'positions'
+inline std::size_t find_headers(const upd::byte_t *begin, const upd::byte_t *end, std::size_t *positions,
+                                std::size_t capacity) {
+  using namespace detail;
+
+  std::size_t count = 0;
+  if (capacity == 0)
+    return 0;
+
+  for_each_occurrence(begin, end, header[2], [&](const upd::byte_t *ptr) -> bool {
+    if (ptr - begin < 2 || end - ptr < 2 || ptr[1] != header[3] || ptr[-1] != header[1] || ptr[-2] != header[0])
+      return true;
+
+    // The state of a sentry only depends on the bytes following the last one which is neither 0xff nor 0xfd
+    auto first = ptr - 2;
+    while (first != begin && (first[-1] == header[0] || first[-1] == header[2]))
+      --first;
+
+    sentry s;
+    for (auto it = first; it != ptr + 1; ++it)
+      s(*it);
+    if (s(ptr[1]))
+      positions[count++] = ptr + 1 - begin;
+    return count != capacity;
+  });
+
+  return count;
+}
+
+//! \brief Find the bytes after which a stuffing byte must be inserted (or has been inserted) in a contiguous buffer
+//! \details
+//!   The result is the same as calling a 'stuffing_sentry' object on every byte of the buffer and recording the
+//!   positions at which it returns 'true'.
+//! \param begin, end Buffer to search in
+//! \param positions Array receiving the offsets of the last byte of each sequence
+//! \param capacity Size of the 'positions' array
+//! \return the number of offsets written to 'positions'
+inline std::size_t find_stuffing(const upd::byte_t *begin, const upd::byte_t *end, std::size_t *positions,
+                                 std::size_t capacity) {
+  using namespace detail;
+
+  std::size_t count = 0;
+  if (capacity == 0)
+    return 0;
+
+  for_each_occurrence(begin, end, header[2], [&](const upd::byte_t *ptr) -> bool {
+    if (ptr - begin >= 2 && ptr[-1] == header[1] && ptr[-2] == header[0])
+      positions[count++] = ptr - begin;
+    return count != capacity;
+  });
+
+  return count;
+}
+
+} // namespace v2
+} // namespace ldp
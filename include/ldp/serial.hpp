@@ -0,0 +1,448 @@
+//! \file
+//! \brief Serial port transport for Linux
+
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <system_error>
+
+#include <fcntl.h>
+#include <linux/serial.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/uio.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <tl/expected.hpp>
+#include <upd/type.hpp>
+
+#include "instrumentation.hpp"
+#include "packet.hpp"
+#include "sentry.hpp"
+#include "ticket.hpp"
+
+// The terminal settings below follow the generic layout of the kernel, which these architectures do not use
+#if defined(__alpha__) || defined(__mips__) || defined(__powerpc__) || defined(__sparc__)
+#error "ldp/serial.hpp does not support the terminal settings of this architecture"
+#endif
+
+namespace ldp {
+inline namespace v2 {
+namespace detail {
+
+//! \brief Kernel terminal settings accepting an arbitrary baud rate
+//! \details
+//!   This is 'termios2' from <asm/termbits.h>, which cannot be included along with <termios.h>. The layout is the
+//!   generic one of the kernel (x86, ARM, RISC-V...). Alpha, MIPS, PowerPC and SPARC define their own, along with other
+//!   ioctl numbers and flag values, so the header does not build there.
+struct termios2 {
+  tcflag_t c_iflag;
+  tcflag_t c_oflag;
+  tcflag_t c_cflag;
+  tcflag_t c_lflag;
+  cc_t c_line;
+  cc_t c_cc[19];
+  speed_t c_ispeed;
+  speed_t c_ospeed;
+};
+
+//! \brief Request reading the 'termios2' settings of a terminal
+constexpr unsigned long tcgets2 = _IOR('T', 0x2a, termios2);
+
+//! \brief Request writing the 'termios2' settings of a terminal
+constexpr unsigned long tcsets2 = _IOW('T', 0x2b, termios2);
+
+//! \brief Value of the baud rate bits of 'c_cflag' meaning that the speed is given by 'c_ispeed' and 'c_ospeed'
+constexpr tcflag_t bother = 0x1000;
+
+//! \brief Shift from the output baud rate bits of 'c_cflag' to the input ones
+constexpr unsigned ibshift = 16;
+
+} // namespace detail
+
+//! \brief Serial bus backed by a Linux TTY device
+//! \details
+//!   The port is configured in raw mode with a 8N1 frame and an arbitrary baud rate (through 'termios2'). Low latency
+//!   mode is requested from the driver when it supports it. Bytes are buffered in both directions: pending output is
+//!   flushed before any read, and reads fetch as many bytes as available in one system call.
+//!   An instance is both an output functor and an input functor, so it can be passed to 'request::operator>>' and
+//!   'ticket::operator<<'. When no byte is received before the timeout expires, the input functor returns 0 and
+//!   'timed_out' is set. The flag stays set until 'clear' is called (which 'await_header' and 'receive' do first), and
+//!   meanwhile the input functor returns 0 at once rather than waiting for the timeout again, so that a packet cut
+//!   short does not cost a timeout per missing byte.
+class serial_bus {
+public:
+  //! \brief Size of the input and output buffers
+  constexpr static std::size_t buffer_size = 256;
+
+  //! \brief Take ownership of an open file descriptor
+  //! \details The file descriptor is not configured. Prefer 'open_serial_bus' to open a TTY device.
+  //! \param fd File descriptor of the serial port
+  //! \param baudrate Baud rate of the serial port, used to compute the receive timeout
+  explicit serial_bus(int fd, unsigned long baudrate)
+      : m_fd{fd}, m_timeout{default_timeout(baudrate, false)}, m_input_begin{m_input}, m_input_end{m_input},
+        m_output_end{m_output}, m_timed_out{false} {}
+
+  serial_bus(const serial_bus &) = delete;
+  serial_bus &operator=(const serial_bus &) = delete;
+
+  serial_bus(serial_bus &&other) noexcept
+      : m_fd{other.m_fd}, m_timeout{other.m_timeout}, m_input_begin{m_input}, m_input_end{m_input},
+        m_output_end{m_output}, m_timed_out{other.m_timed_out} {
+    m_input_end = std::copy(other.m_input_begin, other.m_input_end, m_input);
+    m_output_end = std::copy(other.m_output, other.m_output_end, m_output);
+    other.m_fd = -1;
+  }
+
+  serial_bus &operator=(serial_bus &&other) noexcept {
+    if (this != &other) {
+      close();
+      m_fd = other.m_fd;
+      m_timeout = other.m_timeout;
+      m_input_begin = m_input;
+      m_input_end = std::copy(other.m_input_begin, other.m_input_end, m_input);
+      m_output_end = std::copy(other.m_output, other.m_output_end, m_output);
+      m_timed_out = other.m_timed_out;
+      other.m_fd = -1;
+    }
+
+    return *this;
+  }
+
+  ~serial_bus() { close(); }
+
+  //! \brief Write a byte to the output buffer
+  //! \details The output buffer is flushed when full.
+  //! \param byte Byte to send
+  void operator()(upd::byte_t byte) {
+    if (m_output_end == m_output + buffer_size)
+      flush();
+    *m_output_end++ = byte;
+  }
+
+  //! \brief Read a byte from the input buffer
+  //! \details
+  //!   The output buffer is flushed first. When the input buffer is empty, it is refilled with as many bytes as
+  //!   available on the port. If none arrives before the timeout expires, 'timed_out' is set and 0 is returned. Once
+  //!   'timed_out' is set, 0 is returned without waiting until 'clear' is called.
+  //! \return The received byte
+  upd::byte_t operator()() {
+    if (m_input_begin == m_input_end && (m_timed_out || fill() == 0)) {
+      m_timed_out = true;
+      return 0;
+    }
+
+    return *m_input_begin++;
+  }
+
+  //! \brief Send a byte sequence
+  //! \details The output buffer is flushed first, then the sequence is written without being copied.
+  //! \param begin, end Byte sequence to send
+  //! \return Whether the whole sequence has been written
+  bool write(const upd::byte_t *begin, const upd::byte_t *end) {
+    mark_sent();
+    return flush() && write_all(begin, end);
+  }
+
+  //! \brief Send a packet described by segments
+  //! \details
+  //!   The output buffer is flushed first, then the segments (see 'write_packet') are written with 'writev' without
+  //!   being copied.
+  //! \param segments, count Segments to send
+  //! \return Whether every segment has been written
+  bool write(const packet_segment *segments, std::size_t count) {
+    constexpr std::size_t batch_size = 64;
+
+    mark_sent();
+    if (!flush())
+      return false;
+
+    iovec iov[batch_size];
+    while (count != 0) {
+      std::size_t size = 0;
+      for (; count != 0 && size != batch_size; ++segments, --count) {
+        if (segments->size != 0)
+          iov[size++] = iovec{const_cast<upd::byte_t *>(segments->data), segments->size};
+      }
+      if (!writev_all(iov, size))
+        return false;
+    }
+
+    return true;
+  }
+
+  //! \brief Receive up to 'size' bytes
+  //! \details Buffered bytes are returned first. The call returns as soon as at least one byte has been received.
+  //! \param buf Buffer receiving the bytes
+  //! \param size Capacity of 'buf'
+  //! \return The number of received bytes, 0 if the timeout expired
+  std::size_t read(upd::byte_t *buf, std::size_t size) {
+    if (size == 0)
+      return 0;
+
+    if (m_input_begin == m_input_end) {
+      if (!flush() || !wait())
+        return 0;
+
+      auto count = ::read(m_fd, buf, size);
+      return count > 0 ? static_cast<std::size_t>(count) : 0;
+    }
+
+    auto count = std::min<std::size_t>(size, m_input_end - m_input_begin);
+    std::memcpy(buf, m_input_begin, count);
+    m_input_begin += count;
+    return count;
+  }
+
+  //! \brief Send the content of the output buffer
+  //! \return Whether the content has been fully written
+  bool flush() {
+    auto end = m_output_end;
+    if (end != m_output)
+      mark_sent();
+    m_output_end = m_output;
+    return write_all(m_output, end);
+  }
+
+  //! \brief Discard the input buffer and any byte received by the driver but not read yet
+  void discard() {
+    m_input_begin = m_input_end = m_input;
+    ::ioctl(m_fd, TCFLSH, TCIFLUSH);
+  }
+
+  //! \brief Skip incoming bytes until a header has been received
+  //! \details The timeout flag is reset first.
+  //! \return Whether a header has been received before the timeout expired
+  bool await_header() {
+    m_timed_out = false;
+    sentry snt;
+    for (std::size_t count = 1;; ++count) {
+      auto byte = operator()();
+      if (m_timed_out)
+        return false;
+      if (snt(byte)) {
+        detail::count_header_search(count);
+        return true;
+      }
+    }
+  }
+
+  //! \brief Receive the response to a request
+  //! \details The incoming bytes are skipped until a header is found, then the packet is decoded with the ticket.
+  //! \param tk Ticket of the request
+  //! \return The value extracted by the ticket or an error, 'error::TIMEOUT' if the packet was not fully received
+  template <upd::signed_mode Signed_Mode, typename T, typename... Ts>
+  tl::expected<T, error> receive(const ticket<Signed_Mode, T, Ts...> &tk) {
+    if (!await_header()) {
+      detail::count_error(error::TIMEOUT);
+      return tl::make_unexpected(error::TIMEOUT);
+    }
+
+    auto retval = tk << *this;
+    if (m_timed_out) {
+      detail::count_error(error::TIMEOUT);
+      return tl::make_unexpected(error::TIMEOUT);
+    }
+
+    mark_received();
+    return retval;
+  }
+
+  //! \copybrief receive
+  //! \details The incoming bytes are skipped until a header is found, then the hook of the ticket is called.
+  //! \param tk Ticket of the request
+  //! \return The error returned by the ticket, 'error::TIMEOUT' if the packet was not fully received
+  error receive(const ticket_with_hook &tk) {
+    if (!await_header()) {
+      detail::count_error(error::TIMEOUT);
+      return error::TIMEOUT;
+    }
+
+    auto retval = tk(*this);
+    if (m_timed_out) {
+      detail::count_error(error::TIMEOUT);
+      return error::TIMEOUT;
+    }
+
+    mark_received();
+    return retval;
+  }
+
+  //! \brief Indicates whether a read timed out since the last call to 'clear'
+  bool timed_out() const { return m_timed_out; }
+
+  //! \brief Reset the timeout flag
+  void clear() { m_timed_out = false; }
+
+  //! \brief Maximum duration to wait for an incoming byte
+  std::chrono::microseconds timeout() const { return m_timeout; }
+
+  //! \brief Set the maximum duration to wait for an incoming byte
+  void timeout(std::chrono::microseconds value) { m_timeout = value; }
+
+  //! \brief File descriptor of the serial port
+  int native_handle() const { return m_fd; }
+
+  //! \brief Compute a receive timeout suited for the given baud rate
+  //! \details
+  //!   The timeout covers the transmission of a byte, the maximal return delay of a device and the latency of the
+  //!   driver (typically the latency timer of USB to serial adapters when low latency mode is not available).
+  //! \param baudrate Baud rate of the serial port
+  //! \param low_latency Whether the driver accepted to operate in low latency mode
+  //! \return The duration to wait for an incoming byte
+  static std::chrono::microseconds default_timeout(unsigned long baudrate, bool low_latency) {
+    constexpr unsigned long bits_per_byte = 10, return_delay = 508;
+    auto byte_duration = baudrate != 0 ? (bits_per_byte * 1000000 + baudrate - 1) / baudrate : 0;
+    auto latency = low_latency ? 1000 : 16000;
+    return std::chrono::microseconds{byte_duration + return_delay + latency};
+  }
+
+private:
+  void close() {
+    if (m_fd >= 0)
+      ::close(m_fd);
+    m_fd = -1;
+  }
+
+  bool write_all(const upd::byte_t *begin, const upd::byte_t *end) {
+    while (begin != end) {
+      auto count = ::write(m_fd, begin, end - begin);
+      if (count < 0 && errno == EINTR)
+        continue;
+      if (count < 0 && errno == EAGAIN) {
+        pollfd pfd{m_fd, POLLOUT, 0};
+        ::poll(&pfd, 1, -1);
+        continue;
+      }
+      if (count <= 0)
+        return false;
+      begin += count;
+    }
+
+    return true;
+  }
+
+  bool writev_all(iovec *iov, std::size_t size) {
+    while (size != 0) {
+      auto count = ::writev(m_fd, iov, static_cast<int>(size));
+      if (count < 0 && errno == EINTR)
+        continue;
+      if (count < 0 && errno == EAGAIN) {
+        pollfd pfd{m_fd, POLLOUT, 0};
+        ::poll(&pfd, 1, -1);
+        continue;
+      }
+      if (count <= 0)
+        return false;
+
+      auto written = static_cast<std::size_t>(count);
+      for (; size != 0 && written >= iov->iov_len; ++iov, --size)
+        written -= iov->iov_len;
+      if (size != 0) {
+        iov->iov_base = static_cast<upd::byte_t *>(iov->iov_base) + written;
+        iov->iov_len -= written;
+      }
+    }
+
+    return true;
+  }
+
+  bool wait() {
+    using namespace std::chrono;
+
+    auto deadline = steady_clock::now() + m_timeout;
+    for (;;) {
+      auto remaining = duration_cast<microseconds>(deadline - steady_clock::now()).count();
+      if (remaining < 0)
+        remaining = 0;
+
+      pollfd pfd{m_fd, POLLIN, 0};
+      timespec ts{static_cast<time_t>(remaining / 1000000), static_cast<long>(remaining % 1000000 * 1000)};
+      auto status = ::ppoll(&pfd, 1, &ts, nullptr);
+      if (status > 0)
+        return (pfd.revents & POLLIN) != 0;
+      if (status == 0 || errno != EINTR)
+        return false;
+    }
+  }
+
+#if LDP_ENABLE_INSTRUMENTATION
+  void mark_sent() { m_sent_at = std::chrono::steady_clock::now(); }
+  void mark_received() const { detail::record_latency(std::chrono::steady_clock::now() - m_sent_at); }
+#else
+  void mark_sent() {}
+  void mark_received() const {}
+#endif
+
+  std::size_t fill() {
+    if (!flush() || !wait())
+      return 0;
+
+    auto count = ::read(m_fd, m_input, buffer_size);
+    if (count <= 0)
+      return 0;
+
+    m_input_begin = m_input;
+    m_input_end = m_input + count;
+    return count;
+  }
+
+  int m_fd;
+  std::chrono::microseconds m_timeout;
+  upd::byte_t m_input[buffer_size], *m_input_begin, *m_input_end;
+  upd::byte_t m_output[buffer_size], *m_output_end;
+  bool m_timed_out;
+  // Kept when instrumentation is disabled, so that the layout of the class does not depend on it
+  std::chrono::steady_clock::time_point m_sent_at;
+};
+
+//! \brief Open and configure a serial port
+//! \details
+//!   The port is set in raw mode (8 data bits, no parity, 1 stop bit, no flow control) with the given baud rate, which
+//!   needs not be a standard one. Low latency mode is requested if the driver supports it.
+//! \param path Path to the TTY device
+//! \param baudrate Baud rate of the serial port
+//! \return A serial bus object or the system error which occured
+inline tl::expected<serial_bus, std::error_code> open_serial_bus(const char *path, unsigned long baudrate) {
+  auto make_error = []() { return tl::make_unexpected(std::error_code{errno, std::system_category()}); };
+
+  auto fd = ::open(path, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+  if (fd < 0)
+    return make_error();
+  serial_bus bus{fd, baudrate};
+
+  detail::termios2 tio;
+  if (::ioctl(fd, detail::tcgets2, &tio) < 0)
+    return make_error();
+
+  tio.c_iflag &= ~(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL | IXON | IXOFF | IXANY);
+  tio.c_oflag &= ~OPOST;
+  tio.c_lflag &= ~(ECHO | ECHONL | ICANON | ISIG | IEXTEN);
+  tio.c_cflag &= ~(CSIZE | PARENB | CSTOPB | CRTSCTS | CBAUD | (CBAUD << detail::ibshift));
+  tio.c_cflag |= CS8 | CLOCAL | CREAD | detail::bother | (detail::bother << detail::ibshift);
+  tio.c_ispeed = tio.c_ospeed = baudrate;
+  tio.c_cc[VMIN] = 0;
+  tio.c_cc[VTIME] = 0;
+  if (::ioctl(fd, detail::tcsets2, &tio) < 0)
+    return make_error();
+
+  // Not every driver supports low latency mode (e.g. pseudo-terminals), so failure is not an error
+  serial_struct serial;
+  auto low_latency = ::ioctl(fd, TIOCGSERIAL, &serial) == 0;
+  if (low_latency) {
+    serial.flags |= ASYNC_LOW_LATENCY;
+    low_latency = ::ioctl(fd, TIOCSSERIAL, &serial) == 0;
+  }
+
+  bus.timeout(serial_bus::default_timeout(baudrate, low_latency));
+  bus.discard();
+  return bus;
+}
+
+} // namespace v2
+} // namespace ldp
@@ -0,0 +1,327 @@
+//! \file
+//! \brief Host-side copy of the control tables of several devices
+
+#pragma once
+
+#include <algorithm>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+
+#include <tl/expected.hpp>
+#include <upd/format.hpp>
+#include <upd/type.hpp>
+
+#include "control_table.hpp"
+#include "detail/sfinae.hpp"
+#include "detail/type_list.hpp"
+#include "memzone.hpp"
+#include "packet.hpp"
+#include "read.hpp"
+#include "request.hpp"
+
+#include "detail/def.hpp"
+
+namespace ldp {
+inline namespace v2 {
+
+//! \brief Copy of the control tables of several devices, written back to them on demand
+//! \details
+//!   The bytes of the control table of each device are kept in memory, along with which of them are known (received
+//!   from the device or written locally), which of them have been written locally and which of them have been changed
+//!   since the last flush. Writing a value equal to the cached one does not mark anything as changed.
+//!
+//!   On 'flush', the changed bytes are sent with the fewest sync write instructions: two changed ranges of a device are
+//!   merged if at most 'merge_gap' bytes written locally separate them, and the devices whose ranges are identical are
+//!   written together. The devices do not answer sync write instructions, so the packets follow each other on the bus
+//!   without waiting for any response. Bytes which are only known from the device are never sent,
+//!   since they may belong to read-only fields.
+//! \tparam Table 'control_table' instance describing the memory of the devices
+//! \tparam Capacity Maximum number of devices
+//! \tparam Signed_Mode Signed integer representation of the packets
+template <typename Table, std::size_t Capacity, upd::signed_mode Signed_Mode = upd::signed_mode::TWO_COMPLEMENT>
+class shadow_table;
+
+template <typename... Zones, std::size_t Capacity, upd::signed_mode Signed_Mode>
+class shadow_table<control_table<Zones...>, Capacity, Signed_Mode> {
+  static_assert(Capacity > 0 && Capacity < broadcast, "The capacity must be a valid number of devices");
+
+  using window_t = detail::read_window_t<Zones...>;
+  using table_t = control_table<Zones...>;
+
+public:
+  //! \brief Address of the first cached byte
+  constexpr static address_t base = window_t::address;
+
+  //! \brief Number of cached bytes per device
+  constexpr static std::size_t size = window_t::length;
+
+  //! \brief Maximum number of unchanged bytes sent to merge two changed ranges of a device
+  //! \details This is the overhead of a sync write instruction packet carrying the data of a single device.
+  constexpr static std::size_t merge_gap = 15;
+
+  //! \brief Process the status packet of a read request and update the cache with its content
+  //! \tparam Zs Memory zones read by the request
+  template <typename... Zs> class read_ticket {
+  public:
+    //! \brief Store the shadow table to update
+    explicit read_ticket(shadow_table *shadow) : m_shadow{shadow} {}
+
+    //! \brief Extract the values of the memory zones from a packet and store them in the cache
+    //! \param ftor Functor which delivers a byte each time it is called
+    template <typename F, sfinae::require_input_ftor<F> = 0>
+    tl::expected<device_data<fields<Zs...>>, error> operator<<(F &&ftor) const {
+      auto retval = fields_read_ticket<Signed_Mode, detail::read_window_t<Zs...>, Zs...>{} << FWD(ftor);
+      if (retval)
+        m_shadow->store(*retval);
+      return retval;
+    }
+
+    //! \copybrief operator<<
+    //! \param it Start of the packet
+    template <typename It, sfinae::require_is_iterator<It> = 0>
+    tl::expected<device_data<fields<Zs...>>, error> operator<<(It it) const {
+      return operator<<([&]() { return *it++; });
+    }
+
+  private:
+    shadow_table *m_shadow;
+  };
+
+  //! \brief Request reading a set of memory zones whose values are stored in the cache on reception
+  //! \tparam Zs Memory zones to read
+  template <typename... Zs> class read_t : public detail::request_base<read_t<Zs...>, read_ticket<Zs...>> {
+  public:
+    //! \brief Store the request to send and the shadow table to update
+    read_t(const fields_read_t<Signed_Mode, Zs...> &request, shadow_table *shadow)
+        : m_request(request), m_shadow{shadow} {}
+
+    //! \brief Call a functor on each byte of the packet
+    //! \param ftor The functor to call
+    //! \return A ticket that interprets the response from the target device and updates the cache
+    template <typename F, sfinae::require_output_ftor<F> = 0> read_ticket<Zs...> write(F &&ftor) const {
+      m_request.write(FWD(ftor));
+      return read_ticket<Zs...>{m_shadow};
+    }
+
+  private:
+    fields_read_t<Signed_Mode, Zs...> m_request;
+    shadow_table *m_shadow;
+  };
+
+  //! \brief Construct a shadow table holding no device
+  shadow_table() : m_slots{}, m_count{0} {}
+
+  //! \brief Record a value to be written on a device
+  //! \details The value is only sent on the next call to 'flush'.
+  //! \tparam Zone Field of the control table
+  //! \param id Identifier of the device
+  //! \param value Value to write
+  //! \return False if the device could not be added to the table
+  template <typename Zone, typename U> bool set(packet_id id, const U &value) {
+    auto slot = acquire(id);
+    if (slot == Capacity)
+      return false;
+
+    upd::byte_t bytes[sizeof(typename Zone::type)];
+    detail::encode_value<Signed_Mode>(static_cast<const typename Zone::type &>(value), bytes);
+    for (std::size_t i = 0, j = offset<Zone>(); i < sizeof bytes; ++i, ++j) {
+      if (m_valid[slot][j] && m_image[slot][j] == bytes[i])
+        continue;
+      m_image[slot][j] = bytes[i];
+      m_valid[slot].set(j);
+      m_written[slot].set(j);
+      m_dirty[slot].set(j);
+    }
+
+    return true;
+  }
+
+  //! \brief Get the cached value of a field of a device
+  //! \tparam Zone Field of the control table
+  //! \param id Identifier of the device
+  //! \param value Receives the value if it is known
+  //! \return False if the value is unknown
+  template <typename Zone> bool get(packet_id id, typename Zone::type &value) const {
+    auto slot = find(id);
+    if (slot == Capacity)
+      return false;
+
+    for (std::size_t j = offset<Zone>(); j < offset<Zone>() + sizeof(typename Zone::type); ++j) {
+      if (!m_valid[slot][j])
+        return false;
+    }
+
+    value = detail::decode_value<Signed_Mode, typename Zone::type>(m_image[slot] + offset<Zone>());
+    return true;
+  }
+
+  //! \brief Update the cache with a value received from a device
+  //! \details The bytes which have been changed with 'set' and not flushed yet are left untouched.
+  //! \tparam Zone Field of the control table
+  //! \param id Identifier of the device
+  //! \param value Value held by the device
+  //! \return False if the device could not be added to the table
+  template <typename Zone, typename U> bool store(packet_id id, const U &value) {
+    auto slot = acquire(id);
+    if (slot == Capacity)
+      return false;
+
+    upd::byte_t bytes[sizeof(typename Zone::type)];
+    detail::encode_value<Signed_Mode>(static_cast<const typename Zone::type &>(value), bytes);
+    for (std::size_t i = 0, j = offset<Zone>(); i < sizeof bytes; ++i, ++j) {
+      if (m_dirty[slot][j])
+        continue;
+      m_image[slot][j] = bytes[i];
+      m_valid[slot].set(j);
+    }
+
+    return true;
+  }
+
+  //! \copybrief store
+  //! \details The bytes which have been changed with 'set' and not flushed yet are left untouched.
+  //! \param data Identifier of the device and values of the fields it holds
+  //! \return False if the device could not be added to the table
+  template <typename... Zs> bool store(const device_data<fields<Zs...>> &data) {
+    bool results[] = {store<Zs>(data.id, data.value.template get<Zs>())...};
+    return std::all_of(results, results + sizeof...(Zs), [](bool result) { return result; });
+  }
+
+  //! \brief Forget everything known about a device
+  //! \details This must be called when the device has been rebooted or reset.
+  //! \param id Identifier of the device
+  void invalidate(packet_id id) {
+    auto slot = find(id);
+    if (slot == Capacity)
+      return;
+
+    m_valid[slot].reset();
+    m_written[slot].reset();
+    m_dirty[slot].reset();
+  }
+
+  //! \brief Check whether a device has changes waiting to be flushed
+  //! \param id Identifier of the device
+  bool dirty(packet_id id) const {
+    auto slot = find(id);
+    return slot != Capacity && m_dirty[slot].any();
+  }
+
+  //! \brief Prepare a read instruction whose result is stored in the cache on reception
+  //! \tparam Zs Fields to read
+  //! \param id Identifier of the target device
+  //! \return A request object whose ticket extracts a 'device_data<fields<Zs...>>'
+  template <typename... Zs> read_t<Zs...> read(packet_id id) {
+    return read_t<Zs...>{table_t::template read<Zs...>(upd::signed_mode_h<Signed_Mode>{}, id), this};
+  }
+
+  //! \brief Send the changed bytes of every device
+  //! \details
+  //!   Each changed range is sent with a sync write instruction, along with the devices which share the same range.
+  //!   Unlike write instructions, sync write instructions are not answered, so no response is to be awaited.
+  //! \param ftor Functor called on each byte of the packets
+  //! \return The number of instructions sent
+  template <typename F, sfinae::require_output_ftor<F> = 0> std::size_t flush(F &&ftor) {
+    std::size_t retval = 0;
+
+    for (std::size_t slot = 0; slot < m_count; ++slot) {
+      std::size_t first, last;
+      while (next_range(slot, first, last)) {
+        detail::encode_value<Signed_Mode>(static_cast<address_t>(base + first), m_scratch);
+        detail::encode_value<Signed_Mode>(static_cast<std::uint16_t>(last - first), m_scratch + sizeof(address_t));
+        auto ptr = append_entry(m_scratch + sizeof(address_t) + sizeof(std::uint16_t), slot, first, last);
+
+        for (auto other = slot + 1; other < m_count; ++other) {
+          std::size_t other_first, other_last;
+          if (next_range(other, other_first, other_last) && other_first == first && other_last == last)
+            ptr = append_entry(ptr, other, first, last);
+        }
+
+        write_packet(ftor, upd::signed_mode_h<Signed_Mode>{}, broadcast, instruction::SYNC_WRITE, m_scratch, ptr);
+        ++retval;
+      }
+    }
+
+    return retval;
+  }
+
+private:
+  template <typename Zone> constexpr static std::size_t offset() {
+    static_assert(detail::contains<Zone, Zones...>::value, "The field must be part of the control table");
+    return Zone::address - base;
+  }
+
+  std::size_t find(packet_id id) const {
+    return id < broadcast && m_slots[id] != 0 ? m_slots[id] - 1 : Capacity;
+  }
+
+  std::size_t acquire(packet_id id) {
+    if (id >= broadcast)
+      return Capacity;
+    if (m_slots[id] != 0)
+      return m_slots[id] - 1;
+    if (m_count == Capacity)
+      return Capacity;
+
+    m_ids[m_count] = id;
+    m_valid[m_count].reset();
+    m_written[m_count].reset();
+    m_dirty[m_count].reset();
+    m_slots[id] = static_cast<std::uint8_t>(++m_count);
+    return m_count - 1;
+  }
+
+  //! \brief Find the first range of changed bytes of a device, merged with the following ones when worth it
+  bool next_range(std::size_t slot, std::size_t &first, std::size_t &last) const {
+    const auto &dirty = m_dirty[slot];
+
+    for (first = 0; first < size && !dirty[first]; ++first)
+      ;
+    if (first == size)
+      return false;
+
+    last = first + 1;
+    for (auto i = last; i < size; ++i) {
+      if (dirty[i])
+        last = i + 1;
+      else if (!m_written[slot][i] || i - last >= merge_gap)
+        break;
+    }
+
+    return true;
+  }
+
+  upd::byte_t *append_entry(upd::byte_t *dest, std::size_t slot, std::size_t first, std::size_t last) {
+    *dest++ = m_ids[slot];
+    dest = std::copy(m_image[slot] + first, m_image[slot] + last, dest);
+    clear(slot, first, last);
+    return dest;
+  }
+
+  void clear(std::size_t slot, std::size_t first, std::size_t last) {
+    for (auto i = first; i < last; ++i)
+      m_dirty[slot].reset(i);
+  }
+
+  std::uint8_t m_slots[broadcast];
+  packet_id m_ids[Capacity];
+  std::size_t m_count;
+  upd::byte_t m_image[Capacity][size];
+  std::bitset<size> m_valid[Capacity];
+  std::bitset<size> m_written[Capacity];
+  std::bitset<size> m_dirty[Capacity];
+  upd::byte_t m_scratch[sizeof(address_t) + sizeof(std::uint16_t) + Capacity * (sizeof(packet_id) + size)];
+};
+
+template <typename... Zones, std::size_t Capacity, upd::signed_mode Signed_Mode>
+constexpr address_t shadow_table<control_table<Zones...>, Capacity, Signed_Mode>::base;
+template <typename... Zones, std::size_t Capacity, upd::signed_mode Signed_Mode>
+constexpr std::size_t shadow_table<control_table<Zones...>, Capacity, Signed_Mode>::size;
+template <typename... Zones, std::size_t Capacity, upd::signed_mode Signed_Mode>
+constexpr std::size_t shadow_table<control_table<Zones...>, Capacity, Signed_Mode>::merge_gap;
+
+} // namespace v2
+} // namespace ldp
+
+#include "detail/undef.hpp" // IWYU pragma: keep
@@ -0,0 +1,461 @@
+//! \file
+//! \brief Simulated devices answering instruction packets
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <tl/expected.hpp>
+#include <upd/format.hpp>
+#include <upd/type.hpp>
+
+#include "detail/packet.hpp"
+#include "instrumentation.hpp"
+#include "packet.hpp"
+#include "parser.hpp"
+
+namespace ldp {
+inline namespace v2 {
+
+//! \brief Activity of a simulator since its construction
+struct simulator_report {
+  //! \brief Number of instruction packets processed
+  std::size_t instructions;
+
+  //! \brief Number of status packets emitted
+  std::size_t responses;
+
+  //! \brief Number of bytes received from the host
+  std::size_t bytes_received;
+
+  //! \brief Number of bytes delivered to the host
+  std::size_t bytes_sent;
+
+  //! \brief Simulated time elapsed on the bus
+  std::chrono::nanoseconds bus_time;
+
+  //! \brief Time spent by the simulator processing the instruction packets
+  std::chrono::nanoseconds processing_time;
+
+  //! \brief Number of instruction packets the simulator is able to process per second
+  double instructions_per_second() const {
+    return processing_time.count() != 0 ? instructions * 1e9 / processing_time.count() : 0;
+  }
+};
+
+//! \brief Bus of simulated devices
+//! \details
+//!   The simulator is a functor which can be used in place of a real bus: instruction packets are written to it with
+//!   'operator()(upd::byte_t)' (e.g. by 'request::operator>>') and the status packets of the devices are read from it
+//!   with 'operator()()' (e.g. by 'ticket::operator<<'). It can also be fed and drained by blocks with 'receive' and
+//!   'transmit', for instance to serve a pseudoterminal (see 'simulator_pty').
+//!
+//!   Every device holds its own memory. The following instructions are supported: PING, READ, WRITE, SYNC_READ,
+//!   FAST_SYNC_READ, SYNC_WRITE, BULK_READ and BULK_WRITE. A device answers any other instruction sent to it with
+//!   'error::INSTRUCTION'. Malformed packets are ignored.
+//!
+//!   The simulator keeps a simulated clock. When a baud rate is given, every byte takes the time to be transmitted on
+//!   the bus, and each device waits for its return delay before answering. Reading a byte from the simulator moves the
+//!   clock to the time the byte is received by the host.
+class simulator {
+  struct device {
+    packet_id id;
+    std::vector<upd::byte_t> memory;
+    std::uint16_t model_number;
+    std::uint8_t firmware_version;
+    std::chrono::nanoseconds return_delay;
+    detail::error_t injected_error;
+    std::size_t error_count, drop_count, corrupt_count;
+  };
+
+  struct pending_byte {
+    upd::byte_t value;
+    std::chrono::nanoseconds arrival;
+  };
+
+public:
+  //! \brief Maximum size of the field 'Param' of the instruction packets (after byte stuffing removal)
+  constexpr static std::size_t capacity = 4096;
+
+  //! \brief Construct a simulator without devices
+  //! \param baudrate Baud rate of the simulated bus, or 0 to transmit the bytes instantly
+  explicit simulator(unsigned long baudrate = 0)
+      : m_byte_time{baudrate != 0 ? 10000000000ull / baudrate : 0}, m_now{0}, m_free{0}, m_read{0},
+        m_timed_out{false}, m_report{} {
+    std::fill(m_slots, m_slots + broadcast, std::size_t{0});
+  }
+
+  //! \brief Add a device to the bus
+  //! \details The return delay of the device is initially 250 microseconds.
+  //! \param id Identifier of the device
+  //! \param memory_size Size of the memory of the device (initialized to zero)
+  //! \param model_number Model number reported by a ping instruction
+  //! \param firmware_version Firmware version reported by a ping instruction
+  //! \return False if the identifier is invalid or already in use
+  bool add(packet_id id, std::size_t memory_size = 1024, std::uint16_t model_number = 0,
+           std::uint8_t firmware_version = 0) {
+    if (id >= broadcast || m_slots[id] != 0)
+      return false;
+
+    m_devices.push_back(device{id, std::vector<upd::byte_t>(memory_size), model_number, firmware_version,
+                               std::chrono::microseconds{250}, 0, 0, 0, 0});
+    m_slots[id] = m_devices.size();
+    return true;
+  }
+
+  //! \brief Memory of a device, or a null pointer if the device does not exist
+  upd::byte_t *memory(packet_id id) {
+    auto dev = find(id);
+    return dev ? dev->memory.data() : nullptr;
+  }
+
+  //! \brief Set the time a device waits before answering an instruction
+  void return_delay(packet_id id, std::chrono::nanoseconds delay) {
+    if (auto dev = find(id))
+      dev->return_delay = delay;
+  }
+
+  //! \brief Make a device report an error in its next responses
+  //! \param id Identifier of the device
+  //! \param err Error to report, with the alert flag
+  //! \param count Number of responses affected
+  void inject_error(packet_id id, error err, std::size_t count = 1) {
+    if (auto dev = find(id)) {
+      dev->injected_error = static_cast<detail::error_t>(err.type | (err.alert ? detail::alert_bm : 0));
+      dev->error_count = count;
+    }
+  }
+
+  //! \brief Make a device skip its next responses
+  void drop_responses(packet_id id, std::size_t count = 1) {
+    if (auto dev = find(id))
+      dev->drop_count = count;
+  }
+
+  //! \brief Make a device send its next responses with an incorrect CRC
+  void corrupt_responses(packet_id id, std::size_t count = 1) {
+    if (auto dev = find(id))
+      dev->corrupt_count = count;
+  }
+
+  //! \brief Receive a byte from the host
+  //! \details
+  //!   The byte is transmitted after the previous one. The packets parsed and sent by the devices meanwhile are not
+  //!   counted in 'statistics', which only describe what the host sees of the bus.
+  void operator()(upd::byte_t byte) {
+    detail::uncounted_scope uncounted;
+
+    m_now += m_byte_time;
+    ++m_report.bytes_received;
+    m_parser.push(byte, [&](const tl::expected<frame, error> &maybe_frame) {
+      if (maybe_frame)
+        process(*maybe_frame);
+    });
+  }
+
+  //! \brief Deliver the next byte sent by the devices to the host
+  //! \details If the devices have nothing to send, 'timed_out' is set and 0 is returned.
+  upd::byte_t operator()() {
+    if (m_read == m_output.size()) {
+      m_timed_out = true;
+      return 0;
+    }
+
+    auto byte = m_output[m_read++];
+    m_now = std::max(m_now, byte.arrival);
+    ++m_report.bytes_sent;
+    compact();
+    return byte.value;
+  }
+
+  //! \brief Receive a sequence of bytes from the host
+  void receive(const upd::byte_t *begin, const upd::byte_t *end) {
+    for (; begin != end; ++begin)
+      operator()(*begin);
+  }
+
+  //! \brief Deliver the bytes received by the host until a given time
+  //! \details The clock is moved to 'until' if it is behind.
+  //! \param buf Buffer receiving the bytes
+  //! \param size Capacity of the buffer
+  //! \param until Simulated time (see 'time')
+  //! \return The number of bytes written in the buffer
+  std::size_t transmit(upd::byte_t *buf, std::size_t size, std::chrono::nanoseconds until) {
+    m_now = std::max(m_now, until);
+
+    std::size_t count = 0;
+    for (; count < size && m_read != m_output.size() && m_output[m_read].arrival <= m_now; ++count)
+      buf[count] = m_output[m_read++].value;
+    m_report.bytes_sent += count;
+    compact();
+    return count;
+  }
+
+  //! \brief Time at which the next byte sent by the devices is received by the host, if any
+  tl::expected<std::chrono::nanoseconds, error> next_arrival() const {
+    if (m_read == m_output.size())
+      return tl::make_unexpected(error::TIMEOUT);
+    return m_output[m_read].arrival;
+  }
+
+  //! \brief Number of bytes sent by the devices and not delivered yet
+  std::size_t pending() const { return m_output.size() - m_read; }
+
+  //! \brief Current simulated time
+  std::chrono::nanoseconds time() const { return m_now; }
+
+  //! \brief Indicates whether a byte was read while none was pending, since the last call to 'clear'
+  bool timed_out() const { return m_timed_out; }
+
+  //! \brief Reset the timeout flag
+  void clear() { m_timed_out = false; }
+
+  //! \brief Activity of the simulator
+  simulator_report report() const {
+    auto retval = m_report;
+    retval.bus_time = m_now;
+    return retval;
+  }
+
+private:
+  device *find(packet_id id) { return id < broadcast && m_slots[id] != 0 ? &m_devices[m_slots[id] - 1] : nullptr; }
+
+  void compact() {
+    if (m_read == m_output.size()) {
+      m_output.clear();
+      m_read = 0;
+    }
+  }
+
+  static std::size_t le16(const upd::byte_t *ptr) { return ptr[0] | ptr[1] << 8u; }
+
+  void process(const frame &f) {
+    using clock = std::chrono::steady_clock;
+
+    if (f.ins == instruction::RETURN)
+      return;
+
+    auto start = clock::now();
+    m_free = std::max(m_free, m_now);
+    ++m_report.instructions;
+
+    auto params = f.parameters;
+    auto size = f.size;
+    switch (f.ins) {
+    case instruction::PING:
+      if (f.id == broadcast) {
+        for (std::size_t id = 0; id < broadcast; ++id) {
+          if (auto dev = find(id))
+            ping(*dev);
+        }
+      } else if (auto dev = find(f.id)) {
+        ping(*dev);
+      }
+      break;
+    case instruction::READ:
+      if (auto dev = find(f.id)) {
+        if (size != 4)
+          respond(*dev, error::DATA_LENGTH, nullptr, 0);
+        else
+          read(*dev, le16(params), le16(params + 2));
+      }
+      break;
+    case instruction::WRITE:
+      if (size < 2) {
+        if (auto dev = find(f.id))
+          respond(*dev, error::DATA_LENGTH, nullptr, 0);
+      } else if (f.id == broadcast) {
+        for (auto &dev : m_devices)
+          store(dev, le16(params), params + 2, size - 2);
+      } else if (auto dev = find(f.id)) {
+        respond(*dev, store(*dev, le16(params), params + 2, size - 2) ? error::OK : error::ACCESS, nullptr, 0);
+      }
+      break;
+    case instruction::SYNC_READ:
+      if (size >= 4) {
+        for (std::size_t i = 4; i < size; ++i) {
+          if (auto dev = find(params[i]))
+            read(*dev, le16(params), le16(params + 2));
+        }
+      }
+      break;
+    case instruction::FAST_SYNC_READ:
+      if (size >= 4)
+        fast_sync_read(le16(params), le16(params + 2), params + 4, params + size);
+      break;
+    case instruction::SYNC_WRITE:
+      if (size >= 4) {
+        auto address = le16(params), length = le16(params + 2);
+        for (std::size_t i = 4; i + 1 + length <= size; i += 1 + length) {
+          if (auto dev = find(params[i]))
+            store(*dev, address, params + i + 1, length);
+        }
+      }
+      break;
+    case instruction::BULK_READ:
+      for (std::size_t i = 0; i + 5 <= size; i += 5) {
+        if (auto dev = find(params[i]))
+          read(*dev, le16(params + i + 1), le16(params + i + 3));
+      }
+      break;
+    case instruction::BULK_WRITE:
+      for (std::size_t i = 0; i + 5 <= size && i + 5 + le16(params + i + 3) <= size; i += 5 + le16(params + i + 3)) {
+        if (auto dev = find(params[i]))
+          store(*dev, le16(params + i + 1), params + i + 5, le16(params + i + 3));
+      }
+      break;
+    default:
+      if (auto dev = find(f.id))
+        respond(*dev, error::INSTRUCTION, nullptr, 0);
+      break;
+    }
+
+    m_report.processing_time += clock::now() - start;
+  }
+
+  void ping(device &dev) {
+    const upd::byte_t data[] = {static_cast<upd::byte_t>(dev.model_number & 0xff),
+                                static_cast<upd::byte_t>(dev.model_number >> 8u), dev.firmware_version};
+    respond(dev, error::OK, data, sizeof data);
+  }
+
+  //! \brief Answer a read access
+  //! \details An access out of the memory is answered with 'error::ACCESS' and as many zeros as requested, so that the
+  //!   ticket of the host can report the error.
+  void read(device &dev, std::size_t address, std::size_t length) {
+    if (address + length <= dev.memory.size()) {
+      respond(dev, error::OK, dev.memory.data() + address, length);
+    } else {
+      m_zeros.resize(std::max(m_zeros.size(), length));
+      respond(dev, error::ACCESS, m_zeros.data(), length);
+    }
+  }
+
+  bool store(device &dev, std::size_t address, const upd::byte_t *data, std::size_t length) {
+    if (address + length > dev.memory.size())
+      return false;
+    std::copy(data, data + length, dev.memory.begin() + address);
+    return true;
+  }
+
+  //! \brief Apply the injected faults and compute the error field of a response
+  bool prepare(device &dev, detail::error_t &err) {
+    if (dev.drop_count != 0) {
+      --dev.drop_count;
+      return false;
+    }
+    if (dev.error_count != 0) {
+      --dev.error_count;
+      err = dev.injected_error;
+    }
+    return true;
+  }
+
+  void respond(device &dev, error::type_t type, const upd::byte_t *data, std::size_t length) {
+    auto err = static_cast<detail::error_t>(type);
+    if (!prepare(dev, err))
+      return;
+
+    m_params.assign(1, err);
+    m_params.insert(m_params.end(), data, data + length);
+
+    m_free += dev.return_delay;
+    write_packet([&](upd::byte_t byte) { emit(byte); }, upd::two_complement, dev.id, instruction::RETURN,
+                 m_params.begin(), m_params.end());
+    finish(dev);
+  }
+
+  //! \brief Answer a fast sync read instruction with a single status packet holding a block per device
+  void fast_sync_read(std::size_t address, std::size_t length, const upd::byte_t *ids_begin,
+                      const upd::byte_t *ids_end) {
+    using namespace detail;
+
+    m_params.clear();
+    device *last = nullptr;
+    for (auto ptr = ids_begin; ptr != ids_end; ++ptr) {
+      auto dev = find(*ptr);
+      error_t err = error::OK;
+      if (!dev || !prepare(*dev, err) || address + length > dev->memory.size())
+        continue;
+
+      // The CRC of the packet up to the end of the block is appended once the packet is serialized
+      if (last)
+        m_params.insert(m_params.end(), 2, 0);
+      m_params.push_back(err);
+      m_params.push_back(dev->id);
+      m_params.insert(m_params.end(), dev->memory.begin() + address, dev->memory.begin() + address + length);
+      last = dev;
+    }
+    if (!last)
+      return;
+
+    // The CRC of each block covers the field 'Length', which depends on the stuffing of the CRC of the previous blocks,
+    // so the packet is serialized again until its length is consistent
+    auto block_size = 2 + length + sizeof(crc_t);
+    auto length_field = calculate_length(m_params.begin(), m_params.end());
+    for (;;) {
+      auto fields = upd::make_tuple(upd::little_endian, upd::two_complement, header, broadcast, length_field,
+                                    status_byte);
+      m_wire.assign(fields.begin(), fields.end());
+
+      stuffing_sentry s;
+      crc_t crc = 0;
+      advance_crc(crc, m_wire.data(), m_wire.data() + m_wire.size());
+      auto put = [&](upd::byte_t byte) {
+        m_wire.push_back(byte);
+        advance_crc(crc, byte);
+      };
+      for (std::size_t i = 0; i < m_params.size(); ++i) {
+        if (i % block_size == block_size - sizeof(crc_t)) {
+          m_params[i] = crc & 0xff;
+          m_params[i + 1] = crc >> 8u;
+        }
+        if (s(m_params[i]))
+          put(stuffing_byte);
+        put(m_params[i]);
+      }
+      m_wire.push_back(crc & 0xff);
+      m_wire.push_back(crc >> 8u);
+
+      auto actual = static_cast<length_t>(m_wire.size() - sizeof header - sizeof(packet_id) - sizeof(length_t));
+      if (actual == length_field)
+        break;
+      length_field = actual;
+    }
+
+    m_free += last->return_delay;
+    for (auto byte : m_wire)
+      emit(byte);
+    finish(*last);
+  }
+
+  void emit(upd::byte_t byte) {
+    m_free += m_byte_time;
+    m_output.push_back(pending_byte{byte, m_free});
+  }
+
+  void finish(device &dev) {
+    ++m_report.responses;
+    if (dev.corrupt_count != 0) {
+      --dev.corrupt_count;
+      m_output.back().value ^= 0xff;
+    }
+  }
+
+  std::chrono::nanoseconds m_byte_time, m_now, m_free;
+  std::vector<device> m_devices;
+  std::size_t m_slots[broadcast];
+  parser<capacity> m_parser;
+  std::vector<upd::byte_t> m_params, m_wire, m_zeros;
+  std::vector<pending_byte> m_output;
+  std::size_t m_read;
+  bool m_timed_out;
+  simulator_report m_report;
+};
+
+} // namespace v2
+} // namespace ldp
@@ -0,0 +1,138 @@
+//! \file
+//! \brief Pseudoterminal serving a simulator, for Linux
+
+#pragma once
+
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <system_error>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <tl/expected.hpp>
+#include <upd/type.hpp>
+
+#include "simulator.hpp"
+
+namespace ldp {
+inline namespace v2 {
+
+//! \brief Master side of a pseudoterminal behind which a simulator answers
+//! \details
+//!   The host opens the terminal at 'path' like a serial port (e.g. with 'open_serial_bus', which puts it in raw mode),
+//!   and 'serve' passes the bytes it sends to the simulator and writes the responses of the devices back. The responses
+//!   are written as soon as they are complete: the simulated clock tells when they would be received on a real bus,
+//!   but it is not enforced in real time.
+class simulator_pty {
+public:
+  //! \brief Size of the buffer of the bytes passed in each direction
+  constexpr static std::size_t buffer_size = 256;
+
+  //! \brief Take ownership of the file descriptor of the master side of a pseudoterminal
+  //! \details Prefer 'open_simulator_pty' to open a pseudoterminal.
+  //! \param fd File descriptor of the master side
+  //! \param sim Simulator answering the host
+  explicit simulator_pty(int fd, simulator &sim) : m_fd{fd}, m_sim{&sim} {}
+
+  simulator_pty(const simulator_pty &) = delete;
+  simulator_pty &operator=(const simulator_pty &) = delete;
+
+  simulator_pty(simulator_pty &&other) noexcept : m_fd{other.m_fd}, m_sim{other.m_sim} { other.m_fd = -1; }
+
+  simulator_pty &operator=(simulator_pty &&other) noexcept {
+    if (this != &other) {
+      close();
+      m_fd = other.m_fd;
+      m_sim = other.m_sim;
+      other.m_fd = -1;
+    }
+
+    return *this;
+  }
+
+  ~simulator_pty() { close(); }
+
+  //! \brief Path of the slave side of the pseudoterminal, to be opened by the host
+  const char *path() const { return ::ptsname(m_fd); }
+
+  //! \brief Pass the bytes sent by the host to the simulator and send back the responses of the devices
+  //! \details
+  //!   The bytes available on the terminal are read at once, then every byte the devices have to send is written,
+  //!   moving the simulated clock to the arrival of the last one.
+  //! \param timeout Maximum duration to wait for a byte from the host
+  //! \return The number of bytes received from the host, 0 if none arrived before the timeout expired
+  std::size_t serve(std::chrono::milliseconds timeout) {
+    pollfd pfd{m_fd, POLLIN, 0};
+    if (::poll(&pfd, 1, static_cast<int>(timeout.count())) <= 0 || (pfd.revents & POLLIN) == 0)
+      return 0;
+
+    upd::byte_t buf[buffer_size];
+    auto count = ::read(m_fd, buf, sizeof buf);
+    if (count <= 0)
+      return 0;
+    m_sim->receive(buf, buf + count);
+
+    std::size_t size = 0;
+    for (auto arrival = m_sim->next_arrival(); arrival; arrival = m_sim->next_arrival()) {
+      size += m_sim->transmit(buf + size, sizeof buf - size, *arrival);
+      if (size == sizeof buf) {
+        if (!write_all(buf, buf + size))
+          return static_cast<std::size_t>(count);
+        size = 0;
+      }
+    }
+    write_all(buf, buf + size);
+
+    return static_cast<std::size_t>(count);
+  }
+
+  //! \brief File descriptor of the master side of the pseudoterminal
+  int native_handle() const { return m_fd; }
+
+private:
+  void close() {
+    if (m_fd >= 0)
+      ::close(m_fd);
+    m_fd = -1;
+  }
+
+  bool write_all(const upd::byte_t *begin, const upd::byte_t *end) {
+    while (begin != end) {
+      auto count = ::write(m_fd, begin, end - begin);
+      if (count < 0 && errno == EINTR)
+        continue;
+      if (count <= 0)
+        return false;
+      begin += count;
+    }
+
+    return true;
+  }
+
+  int m_fd;
+  simulator *m_sim;
+};
+
+//! \brief Open a pseudoterminal behind which a simulator answers
+//! \param sim Simulator answering the host
+//! \return A pseudoterminal object or the system error which occured
+inline tl::expected<simulator_pty, std::error_code> open_simulator_pty(simulator &sim) {
+  auto make_error = []() { return tl::make_unexpected(std::error_code{errno, std::system_category()}); };
+
+  auto fd = ::posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+  if (fd < 0)
+    return make_error();
+  simulator_pty pty{fd, sim};
+
+  if (::grantpt(fd) != 0 || ::unlockpt(fd) != 0)
+    return make_error();
+
+  return pty;
+}
+
+} // namespace v2
+} // namespace ldp
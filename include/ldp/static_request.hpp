@@ -0,0 +1,173 @@
+//! \file
+//! \brief Requests serialized at compile time
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include <upd/format.hpp>
+#include <upd/type.hpp>
+
+#include "detail/packet.hpp"
+#include "memzone.hpp"
+#include "packet.hpp"
+#include "ping.hpp"
+#include "read.hpp"
+#include "request.hpp"
+#include "ticket.hpp"
+
+namespace ldp {
+inline namespace v2 {
+namespace detail {
+
+//! \brief Sequence of bytes known at compile time
+template <upd::byte_t... Bytes> struct byte_sequence {};
+
+//! \brief Concatenate byte sequences
+template <typename... Seqs> struct concat;
+template <upd::byte_t... Bytes> struct concat<byte_sequence<Bytes...>> {
+  using type = byte_sequence<Bytes...>;
+};
+template <upd::byte_t... Bytes1, upd::byte_t... Bytes2, typename... Seqs>
+struct concat<byte_sequence<Bytes1...>, byte_sequence<Bytes2...>, Seqs...>
+    : concat<byte_sequence<Bytes1..., Bytes2...>, Seqs...> {};
+
+//! \brief Serialize an unsigned integer known at compile time in little endian
+template <typename T, T Value, std::size_t N = sizeof(T), upd::byte_t... Bytes>
+struct little_endian_bytes : little_endian_bytes<T, (Value >> 8u), N - 1, Bytes..., (Value & 0xff)> {};
+template <typename T, T Value, upd::byte_t... Bytes> struct little_endian_bytes<T, Value, 0, Bytes...> {
+  using type = byte_sequence<Bytes...>;
+};
+
+//! \brief Insert the stuffing bytes in a byte sequence
+//! \details This mirrors the behaviour of 'stuffing_sentry': 'Count' is the number of header bytes matched so far.
+template <std::size_t Count, typename Out, typename In> struct stuff;
+template <std::size_t Count, upd::byte_t... Outs> struct stuff<Count, byte_sequence<Outs...>, byte_sequence<>> {
+  using type = byte_sequence<Outs...>;
+};
+template <std::size_t Count, upd::byte_t... Outs, upd::byte_t Byte, upd::byte_t... Ins>
+struct stuff<Count, byte_sequence<Outs...>, byte_sequence<Byte, Ins...>> {
+  constexpr static std::size_t next = header[Count] == Byte ? Count + 1 : (Byte == 0xff && Count < 3 ? Count : 0);
+  using type = typename std::conditional<next == sizeof header - 1,
+                                         stuff<0, byte_sequence<Outs..., Byte, stuffing_byte>, byte_sequence<Ins...>>,
+                                         stuff<next, byte_sequence<Outs..., Byte>, byte_sequence<Ins...>>>::type::type;
+};
+
+//! \brief Compute the CRC of a byte sequence in a constant expression
+constexpr crc_t static_crc(crc_t crc) { return crc; }
+template <typename... Bytes> constexpr crc_t static_crc(crc_t crc, upd::byte_t byte, Bytes... bytes) {
+  return static_crc(static_cast<crc_t>((crc << 8u) ^ crc_table[((crc >> 8u) ^ byte) & 0xff]), bytes...);
+}
+
+//! \brief Append the CRC to a byte sequence
+template <typename Seq> struct append_crc;
+template <upd::byte_t... Bytes> struct append_crc<byte_sequence<Bytes...>> {
+  constexpr static crc_t crc = static_crc(0, Bytes...);
+  using type = byte_sequence<Bytes..., crc & 0xff, (crc >> 8u) & 0xff>;
+};
+
+//! \brief Number of bytes in a byte sequence
+template <typename Seq> struct length_of;
+template <upd::byte_t... Bytes> struct length_of<byte_sequence<Bytes...>> {
+  constexpr static std::size_t value = sizeof...(Bytes);
+};
+
+//! \brief Make the complete byte sequence of a packet whose fields are known at compile time
+template <packet_id Id, instruction Ins, typename Parameters> struct static_packet {
+  using stuffed_t = typename stuff<0, byte_sequence<>, Parameters>::type;
+  using length_bytes_t = typename little_endian_bytes<length_t, length_t(length_of<stuffed_t>::value + 3)>::type;
+  using type = typename append_crc<typename concat<byte_sequence<header[0], header[1], header[2], header[3], Id>,
+                                                   length_bytes_t, byte_sequence<instruction_t(Ins)>,
+                                                   stuffed_t>::type>::type;
+};
+
+} // namespace detail
+
+//! \brief Request whose packet has been entirely serialized at compile time
+//! \details
+//!   The bytes of the packet, including the byte stuffing and the CRC, are available as a constant expression through
+//!   'bytes'. Sending the request is a mere copy of these bytes.
+//! \tparam Tk Ticket type returned when the request is sent
+//! \tparam Seq 'detail::byte_sequence' of the packet
+template <typename Tk, typename Seq> class static_request;
+template <typename Tk, upd::byte_t... Bytes>
+class static_request<Tk, detail::byte_sequence<Bytes...>>
+    : public detail::request_base<static_request<Tk, detail::byte_sequence<Bytes...>>, Tk> {
+public:
+  //! \brief Bytes of the packet
+  constexpr static std::array<upd::byte_t, sizeof...(Bytes)> bytes = {{Bytes...}};
+
+  //! \brief Call a functor on each byte of the packet
+  //! \param ftor The functor to call
+  //! \return A ticket that can interpret the response from the target device
+  template <typename F, sfinae::require_output_ftor<F> = 0> Tk write(F &&ftor) const {
+    for (auto byte : bytes)
+      ftor(byte);
+    return {};
+  }
+};
+
+template <typename Tk, upd::byte_t... Bytes>
+constexpr std::array<upd::byte_t, sizeof...(Bytes)> static_request<Tk, detail::byte_sequence<Bytes...>>::bytes;
+
+//! \brief Request class for a ping instruction serialized at compile time
+//! \tparam Signed_Mode Signed integer representation of the packets involved in the request
+//! \tparam Id Identifier of the target device
+template <upd::signed_mode Signed_Mode, packet_id Id>
+using static_ping_t =
+    static_request<ticket<Signed_Mode, device_info, std::uint16_t, std::uint8_t>,
+                   typename detail::static_packet<Id, instruction::PING, detail::byte_sequence<>>::type>;
+
+//! \brief Prepare a ping instruction packet at compile time
+//! \tparam Id Identifier of the target device
+//! \tparam Signed_Mode Signed integer representation of the packet
+//! \return A request object whose packet is a constant expression
+template <packet_id Id, upd::signed_mode Signed_Mode>
+constexpr static_ping_t<Signed_Mode, Id> static_ping(upd::signed_mode_h<Signed_Mode>) {
+  return {};
+}
+
+//! \copybrief static_ping
+//! \tparam Id Identifier of the target device
+//! \return A request object whose packet is a constant expression
+template <packet_id Id> constexpr static_ping_t<upd::signed_mode::TWO_COMPLEMENT, Id> static_ping() { return {}; }
+
+//! \brief Request class for a read instruction serialized at compile time
+//! \tparam Signed_Mode Signed integer representation of the packets involved in the request
+//! \tparam Id Identifier of the target device
+//! \tparam Address Start of the memory zone to read on
+//! \tparam T Type associated with the memory zone
+template <upd::signed_mode Signed_Mode, packet_id Id, address_t Address, typename T>
+using static_read_t = static_request<
+    ticket<Signed_Mode, device_data<T>, T>,
+    typename detail::static_packet<
+        Id, instruction::READ,
+        typename detail::concat<typename detail::little_endian_bytes<address_t, Address>::type,
+                                typename detail::little_endian_bytes<std::uint16_t, sizeof(T)>::type>::type>::type>;
+
+//! \brief Prepare a read instruction packet at compile time
+//! \tparam Id Identifier of the target device
+//! \tparam Signed_Mode Signed integer representation of the packet
+//! \tparam Address Start of the memory zone to read on
+//! \tparam T Type associated with the memory zone
+//! \return A request object whose packet is a constant expression
+template <packet_id Id, upd::signed_mode Signed_Mode, address_t Address, typename T>
+constexpr static_read_t<Signed_Mode, Id, Address, T> static_read(upd::signed_mode_h<Signed_Mode>, memzone<Address, T>) {
+  return {};
+}
+
+//! \copybrief static_read
+//! \tparam Id Identifier of the target device
+//! \tparam Address Start of the memory zone to read on
+//! \tparam T Type associated with the memory zone
+//! \return A request object whose packet is a constant expression
+template <packet_id Id, address_t Address, typename T>
+constexpr static_read_t<upd::signed_mode::TWO_COMPLEMENT, Id, Address, T> static_read(memzone<Address, T>) {
+  return {};
+}
+
+} // namespace v2
+} // namespace ldp
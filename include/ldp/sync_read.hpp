@@ -0,0 +1,259 @@
+//! \file
+//! \brief Sync read instruction utilities
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include <upd/format.hpp>
+#include <upd/tuple.hpp>
+
+#include "detail/bus.hpp"
+#include "detail/sfinae.hpp"
+#include "memzone.hpp"
+#include "packet.hpp"
+#include "read.hpp"
+#include "request.hpp"
+#include "ticket.hpp"
+
+#include "detail/def.hpp"
+
+namespace ldp {
+inline namespace v2 {
+
+//! \brief Process the status packets following a sync read request
+//! \tparam Signed_Mode Signed integer convention of the received packets
+//! \tparam T Type of the value extracted from the packets
+//! \tparam N Number of devices expected to answer
+template <upd::signed_mode Signed_Mode, typename T, std::size_t N> class sync_read_ticket {
+public:
+  //! \brief Maximal number of bytes read by 'receive', including the header of the first packet
+  //! \details
+  //!   The header of each packet but the first one is searched for over at most the size of a status packet, and the
+  //!   rest of the packet follows it.
+  constexpr static std::size_t max_size =
+      (2 * N - 1) * detail::max_status_size(sizeof(T)) - (N - 1) * sizeof detail::header;
+
+  //! \brief Store the identifiers of the requested devices
+  //! \param ids Array of size 'N' holding the identifiers, in order of request
+  explicit sync_read_ticket(const packet_id *ids) { std::copy(ids, ids + N, m_ids); }
+
+  //! \brief Extract the values from the status packets of every device
+  //! \details
+  //!   As with 'ticket', the header of the first packet must have been consumed already. The header of each following
+  //!   packet is searched for, so that a packet which could not be read does not prevent reading the next ones. The
+  //!   search covers at most the size of one status packet, and stops when the functor times out if it has a member
+  //!   function 'timed_out' (like 'serial_bus').
+  //!
+  //!   The devices answer in order of request, so a packet coming from a later device means that the devices in
+  //!   between did not answer. Their entry is set to 'error::TIMEOUT', as well as the entries of the devices whose
+  //!   packet was not found. Packets coming from devices which were not requested are ignored.
+  //! \param ftor Functor which delivers a byte each time it is called
+  //! \param ids Array of size 'N' receiving the identifiers of the devices, in order of request
+  //! \param values Array of size 'N' receiving the values
+  //! \param errors Array of size 'N' receiving the status of each device
+  //! \return the number of packets successfully read
+  template <typename F, sfinae::require_input_ftor<F> = 0>
+  std::size_t receive(F &&ftor, packet_id *ids, T *values, error *errors) const {
+    std::copy(m_ids, m_ids + N, ids);
+    std::fill(errors, errors + N, error{error::TIMEOUT});
+
+    std::size_t count = 0, next = 0;
+    for (std::size_t i = 0; i < N && next < N; ++i) {
+      if (i != 0 && !detail::seek_header(ftor, detail::max_status_size(sizeof(T))))
+        break;
+
+      auto maybe_data = ticket<Signed_Mode, device_data<T>, T>{} << ftor;
+      if (!maybe_data) {
+        errors[next++] = maybe_data.error();
+        continue;
+      }
+
+      auto slot = static_cast<std::size_t>(std::find(m_ids + next, m_ids + N, maybe_data->id) - m_ids);
+      if (slot == N)
+        continue;
+
+      values[slot] = maybe_data->value;
+      errors[slot] = error::OK;
+      next = slot + 1;
+      ++count;
+    }
+
+    return count;
+  }
+
+  //! \copybrief receive
+  //! \details
+  //!   Each byte of the packets is delivered by the provided iterator. At most 'max_size' bytes are read, counting the
+  //!   header of the first packet which was consumed already.
+  //! \param it Start of the first packet
+  //! \param ids Array of size 'N' receiving the identifiers of the devices
+  //! \param values Array of size 'N' receiving the values
+  //! \param errors Array of size 'N' receiving the status of each device
+  //! \return the number of packets successfully read
+  template <typename It, sfinae::require_is_iterator<It> = 0>
+  std::size_t receive(It it, packet_id *ids, T *values, error *errors) const {
+    return receive([&]() { return *it++; }, ids, values, errors);
+  }
+
+private:
+  packet_id m_ids[N];
+};
+
+template <upd::signed_mode Signed_Mode, typename T, std::size_t N>
+constexpr std::size_t sync_read_ticket<Signed_Mode, T, N>::max_size;
+
+//! \brief Process the status packet following a fast sync read request
+//! \tparam Signed_Mode Signed integer convention of the received packet
+//! \tparam T Type of the value extracted from the packet
+//! \tparam N Number of devices expected to answer
+template <upd::signed_mode Signed_Mode, typename T, std::size_t N> class fast_sync_read_ticket {
+public:
+  //! \brief Extract the values of every device from the status packet
+  //! \details
+  //!   As with 'ticket', the header of the packet must have been consumed already. If the packet as a whole is
+  //!   invalid, every entry of 'errors' is set to the corresponding error.
+  //! \param ftor Functor which delivers a byte each time it is called
+  //! \param ids Array of size 'N' receiving the identifiers of the devices, in order of response
+  //! \param values Array of size 'N' receiving the values
+  //! \param errors Array of size 'N' receiving the status of each device
+  //! \return the number of devices whose value was successfully read
+  template <typename F, sfinae::require_input_ftor<F> = 0>
+  std::size_t receive(F &&ftor, packet_id *ids, T *values, error *errors) const {
+    upd::byte_t data[N * sizeof(T)];
+    auto maybe_count = read_headerless_fast_sync_packet(FWD(ftor), upd::signed_mode_h<Signed_Mode>{}, ids, errors, N,
+                                                        data, data + sizeof data);
+    if (!maybe_count) {
+      std::fill(errors, errors + N, maybe_count.error());
+      return 0;
+    }
+
+    for (std::size_t i = 0; i < N; ++i) {
+      auto value = upd::make_tuple<T>(upd::little_endian, upd::signed_mode_h<Signed_Mode>{});
+      std::copy(data + i * sizeof(T), data + (i + 1) * sizeof(T), value.begin());
+      values[i] = upd::get<0>(value);
+    }
+
+    return *maybe_count;
+  }
+
+  //! \copybrief receive
+  //! \details
+  //!   Each byte of the packet is delivered by the provided iterator.
+  //! \param it Start of the packet
+  //! \param ids Array of size 'N' receiving the identifiers of the devices
+  //! \param values Array of size 'N' receiving the values
+  //! \param errors Array of size 'N' receiving the status of each device
+  //! \return the number of devices whose value was successfully read
+  template <typename It, sfinae::require_is_iterator<It> = 0>
+  std::size_t receive(It it, packet_id *ids, T *values, error *errors) const {
+    return receive([&]() { return *it++; }, ids, values, errors);
+  }
+};
+
+namespace detail {
+
+//! \brief Make the type of a request object with 'N' device identifiers as parameters
+template <upd::signed_mode Signed_Mode, typename Tk, std::size_t N, typename... Ids>
+struct id_list_request : id_list_request<Signed_Mode, Tk, N - 1, packet_id, Ids...> {};
+template <upd::signed_mode Signed_Mode, typename Tk, typename... Ids>
+struct id_list_request<Signed_Mode, Tk, 0, Ids...> {
+  using type = request<Signed_Mode, Tk, address_t, std::uint16_t, Ids...>;
+};
+
+} // namespace detail
+
+//! \brief Request class for a sync read instruction
+//! \details The ticket keeps the identifiers of the target devices, so that it knows which of them did not answer.
+//! \tparam Signed_Mode Signed integer representation of the packets involved in the request
+//! \tparam T Type of the value to be read
+//! \tparam N Number of target devices
+template <upd::signed_mode Signed_Mode, typename T, std::size_t N>
+class sync_read_t : public detail::request_base<sync_read_t<Signed_Mode, T, N>, sync_read_ticket<Signed_Mode, T, N>> {
+  using packet_t = typename detail::id_list_request<Signed_Mode, no_response, N>::type;
+
+public:
+  //! \brief Store the content of the instruction packet
+  //! \param address Start of the memory zone to read on
+  //! \param ids Identifiers of the target devices
+  template <typename... Ids>
+  explicit sync_read_t(address_t address, Ids... ids)
+      : m_packet{broadcast, instruction::SYNC_READ, address, sizeof(T), ids...}, m_ids{ids...} {}
+
+  //! \brief Call a functor on each byte of the packet
+  //! \param ftor The functor to call
+  //! \return A ticket that can interpret the responses from the target devices
+  template <typename F, sfinae::require_output_ftor<F> = 0> sync_read_ticket<Signed_Mode, T, N> write(F &&ftor) const {
+    m_packet.write(FWD(ftor));
+    return sync_read_ticket<Signed_Mode, T, N>{m_ids};
+  }
+
+private:
+  packet_t m_packet;
+  packet_id m_ids[N];
+};
+
+//! \brief Request class for a fast sync read instruction
+//! \tparam Signed_Mode Signed integer representation of the packets involved in the request
+//! \tparam T Type of the value to be read
+//! \tparam N Number of target devices
+template <upd::signed_mode Signed_Mode, typename T, std::size_t N>
+using fast_sync_read_t =
+    typename detail::id_list_request<Signed_Mode, fast_sync_read_ticket<Signed_Mode, T, N>, N>::type;
+
+//! \brief Prepare the content of a sync read instruction packet
+//! \details The devices will answer in the order of the provided identifiers.
+//! \tparam Signed_Mode Signed integer representation of the packet
+//! \tparam Address Start of the memory zone to read on
+//! \tparam T Type associated with the memory zone
+//! \param ids Identifiers of the target devices
+//! \return A request object that holds the necessary data for a sync read instruction
+template <upd::signed_mode Signed_Mode, address_t Address, typename T, typename... Ids>
+sync_read_t<Signed_Mode, T, sizeof...(Ids)> sync_read(upd::signed_mode_h<Signed_Mode>, memzone<Address, T>,
+                                                      Ids... ids) {
+  return sync_read_t<Signed_Mode, T, sizeof...(Ids)>{Address, static_cast<packet_id>(ids)...};
+}
+
+//! \copybrief sync_read
+//! \details The devices will answer in the order of the provided identifiers.
+//! \tparam Address Start of the memory zone to read on
+//! \tparam T Type associated with the memory zone
+//! \param ids Identifiers of the target devices
+//! \return A request object that holds the necessary data for a sync read instruction
+template <address_t Address, typename T, typename... Ids>
+sync_read_t<upd::signed_mode::TWO_COMPLEMENT, T, sizeof...(Ids)> sync_read(memzone<Address, T>, Ids... ids) {
+  return sync_read(upd::two_complement, memzone<Address, T>{}, ids...);
+}
+
+//! \brief Prepare the content of a fast sync read instruction packet
+//! \details The devices will answer in a single status packet, in the order of the provided identifiers.
+//! \tparam Signed_Mode Signed integer representation of the packet
+//! \tparam Address Start of the memory zone to read on
+//! \tparam T Type associated with the memory zone
+//! \param ids Identifiers of the target devices
+//! \return A request object that holds the necessary data for a fast sync read instruction
+template <upd::signed_mode Signed_Mode, address_t Address, typename T, typename... Ids>
+fast_sync_read_t<Signed_Mode, T, sizeof...(Ids)> fast_sync_read(upd::signed_mode_h<Signed_Mode>, memzone<Address, T>,
+                                                                Ids... ids) {
+  return fast_sync_read_t<Signed_Mode, T, sizeof...(Ids)>{broadcast, instruction::FAST_SYNC_READ, Address, sizeof(T),
+                                                          static_cast<packet_id>(ids)...};
+}
+
+//! \copybrief fast_sync_read
+//! \details The devices will answer in a single status packet, in the order of the provided identifiers.
+//! \tparam Address Start of the memory zone to read on
+//! \tparam T Type associated with the memory zone
+//! \param ids Identifiers of the target devices
+//! \return A request object that holds the necessary data for a fast sync read instruction
+template <address_t Address, typename T, typename... Ids>
+fast_sync_read_t<upd::signed_mode::TWO_COMPLEMENT, T, sizeof...(Ids)> fast_sync_read(memzone<Address, T>,
+                                                                                     Ids... ids) {
+  return fast_sync_read(upd::two_complement, memzone<Address, T>{}, ids...);
+}
+
+} // namespace v2
+} // namespace ldp
+
+#include "detail/undef.hpp" // IWYU pragma: keep
@@ -0,0 +1,116 @@
+//! \file
+//! \brief Sync write instruction utilities
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <iterator>
+
+#include <upd/format.hpp>
+#include <upd/tuple.hpp>
+
+#include "detail/iterator.hpp"
+#include "detail/sfinae.hpp"
+#include "memzone.hpp"
+#include "packet.hpp"
+#include "read.hpp"
+#include "request.hpp"
+#include "ticket.hpp"
+
+#include "detail/def.hpp"
+
+namespace ldp {
+inline namespace v2 {
+
+//! \brief Request class for a sync write instruction
+//! \details The packet is broadcast, therefore no device will answer it.
+//! \tparam Signed_Mode Signed integer representation of the packets involved in the request
+//! \tparam T Type of the value to be written
+//! \tparam R Type of the sequence of 'device_data' to be written
+template <upd::signed_mode Signed_Mode, typename T, typename R>
+class sync_write_t : public detail::request_base<sync_write_t<Signed_Mode, T, R>, no_response> {
+  using fields_t = upd::tuple<upd::endianess::LITTLE, Signed_Mode, address_t, std::uint16_t>;
+  using entry_iterator =
+      detail::entry_iterator<Signed_Mode, packet_id, T, decltype(std::begin(std::declval<const R &>()))>;
+  using iterator = detail::chain_iterator<decltype(std::declval<const fields_t &>().begin()), entry_iterator>;
+
+public:
+  //! \brief Store the values of the instruction packet field
+  //! \param address Start of the memory zone to write on
+  //! \param entries Identifiers of the target devices and the values to write
+  explicit sync_write_t(address_t address, const R &entries) : m_fields{address, sizeof(T)}, m_entries(entries) {}
+
+  //! \brief Call a functor on each byte of the packet
+  //! \param ftor The functor to call
+  //! \return A ticket indicating that no response is expected
+  template <typename F, sfinae::require_output_ftor<F> = 0> no_response write(F &&ftor) const {
+    auto entries_begin = std::begin(m_entries), entries_end = std::end(m_entries);
+    iterator begin{m_fields.begin(), m_fields.end(), entry_iterator{entries_begin, entries_end}},
+        end{m_fields.end(), m_fields.end(), entry_iterator{entries_end, entries_end}};
+
+    write_packet(FWD(ftor), upd::signed_mode_h<Signed_Mode>{}, broadcast, instruction::SYNC_WRITE, begin, end);
+    return {};
+  }
+
+private:
+  fields_t m_fields;
+  R m_entries;
+};
+
+//! \brief Prepare the content of a sync write instruction packet for a fixed number of devices
+//! \details The values are stored in the request object, therefore no allocation is performed.
+//! \tparam Signed_Mode Signed integer representation of the packet
+//! \tparam Address Start of the memory zone to write on
+//! \tparam T Type associated with the memory zone
+//! \param entries Identifiers of the target devices and the values to write
+//! \return A request object that holds the necessary data for a sync write instruction
+template <upd::signed_mode Signed_Mode, address_t Address, typename T, typename... Us>
+sync_write_t<Signed_Mode, T, std::array<device_data<T>, sizeof...(Us)>>
+sync_write(upd::signed_mode_h<Signed_Mode>, memzone<Address, T>, const device_data<Us> &...entries) {
+  using entries_t = std::array<device_data<T>, sizeof...(Us)>;
+  return sync_write_t<Signed_Mode, T, entries_t>{Address, entries_t{{{entries.id, static_cast<T>(entries.value)}...}}};
+}
+
+//! \copybrief sync_write
+//! \tparam Address Start of the memory zone to write on
+//! \tparam T Type associated with the memory zone
+//! \param entries Identifiers of the target devices and the values to write
+//! \return A request object that holds the necessary data for a sync write instruction
+template <address_t Address, typename T, typename... Us>
+sync_write_t<upd::signed_mode::TWO_COMPLEMENT, T, std::array<device_data<T>, sizeof...(Us)>>
+sync_write(memzone<Address, T>, const device_data<Us> &...entries) {
+  return sync_write(upd::two_complement, memzone<Address, T>{}, entries...);
+}
+
+//! \brief Prepare the content of a sync write instruction packet for a sequence of devices
+//! \details
+//!   The request object only refers to the sequence, which must outlive it. The elements of the sequence must have an
+//!   'id' and a 'value' member, such as 'device_data'.
+//! \tparam Signed_Mode Signed integer representation of the packet
+//! \tparam Address Start of the memory zone to write on
+//! \tparam T Type associated with the memory zone
+//! \param begin, end Identifiers of the target devices and the values to write
+//! \return A request object that holds the necessary data for a sync write instruction
+template <upd::signed_mode Signed_Mode, address_t Address, typename T, typename It,
+          sfinae::require_is_iterator<std::iterator_traits<It>> = 0>
+sync_write_t<Signed_Mode, T, detail::range<It>> sync_write(upd::signed_mode_h<Signed_Mode>, memzone<Address, T>,
+                                                           It begin, It end) {
+  return sync_write_t<Signed_Mode, T, detail::range<It>>{Address, detail::range<It>{begin, end}};
+}
+
+//! \copybrief sync_write
+//! \tparam Address Start of the memory zone to write on
+//! \tparam T Type associated with the memory zone
+//! \param begin, end Identifiers of the target devices and the values to write
+//! \return A request object that holds the necessary data for a sync write instruction
+template <address_t Address, typename T, typename It, sfinae::require_is_iterator<std::iterator_traits<It>> = 0>
+sync_write_t<upd::signed_mode::TWO_COMPLEMENT, T, detail::range<It>> sync_write(memzone<Address, T>, It begin,
+                                                                                It end) {
+  return sync_write(upd::two_complement, memzone<Address, T>{}, begin, end);
+}
+
+} // namespace v2
+} // namespace ldp
+
+#include "detail/undef.hpp" // IWYU pragma: keep
@@ -3,6 +3,10 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+
 #include <tl/expected.hpp>
 #include <upd/format.hpp>
 #include <upd/tuple.hpp>
@@ -13,20 +17,51 @@
 
 #include "detail/def.hpp"
 
+#ifndef LDP_HOOK_BUFFER_SIZE
+//! \brief Size of the buffer 'ticket_with_hook' collects a packet into when it is delivered byte per byte
+#define LDP_HOOK_BUFFER_SIZE 256
+#endif // LDP_HOOK_BUFFER_SIZE
+
 namespace ldp {
 inline namespace v2 {
 
 //! \brief Stores a callback to be called on the response from a device
-//! \details This class is non-templated, therefore it is suitable for storage.
+//! \details
+//!   This class is non-templated, therefore it is suitable for storage. The stored callback is called on a contiguous
+//!   byte sequence, so that no indirect call is made per received byte.
 class ticket_with_hook {
   template <upd::signed_mode, typename, typename...> friend class ticket;
 
 public:
+  //! \brief Make an empty ticket which holds no callback
+  //! \details This is meant for storage; an empty ticket must not be called.
+  ticket_with_hook() : m_callback_ptr{nullptr}, m_restorer{nullptr}, m_frame_restorer{nullptr} {}
+
+  //! \brief Maximal size of a packet (without header) delivered by a functor or an iterator
+  constexpr static std::size_t buffer_size = LDP_HOOK_BUFFER_SIZE;
+
   //! \brief Call the stored callback on the provided parameters
+  //! \details
+  //!   The packet is first collected in a buffer of 'buffer_size' bytes, according to its field 'Length'. If it does
+  //!   not fit, 'error::BAD_LENGTH' is returned right after the field 'Length' and the rest of the packet is left
+  //!   unread.
   //! \param input_ftor Input functor the parameters will be extracted from
   //! \return The error code resulting from the call to 'read_headerless_packet'
   template <typename F, sfinae::require_input_ftor<F> = 0> error operator()(F &&input_ftor) const {
-    return m_restorer(m_callback_ptr, detail::abstract_input_functor<F>{input_ftor});
+    upd::byte_t buf[buffer_size];
+    constexpr auto fields_size = sizeof(packet_id) + sizeof(detail::length_t);
+
+    for (std::size_t i = 0; i < fields_size; ++i)
+      buf[i] = input_ftor();
+
+    std::size_t length = buf[1] | buf[2] << 8u;
+    if (length > buffer_size - fields_size)
+      return error::BAD_LENGTH;
+
+    for (auto ptr = buf + fields_size; ptr != buf + fields_size + length; ++ptr)
+      *ptr = input_ftor();
+
+    return operator()(buf, buf + fields_size + length);
   }
 
   //! \copybrief operator()
@@ -36,6 +71,22 @@ public:
     return operator()([&]() { return *it++; });
   }
 
+  //! \copybrief operator()
+  //! \details The sequence is not copied and is never read past its end.
+  //! \param begin, end Packet (without header) the parameters will be extracted from
+  //! \return The error code resulting from the call to 'read_headerless_packet'
+  error operator()(const upd::byte_t *begin, const upd::byte_t *end) const {
+    return m_restorer(m_callback_ptr, begin, end);
+  }
+
+  //! \copybrief operator()
+  //! \param f Packet already parsed by 'parser'
+  //! \return The error code resulting from the call to 'ticket::operator<<'
+  error operator()(const frame &f) const { return m_frame_restorer(m_callback_ptr, f); }
+
+  //! \brief Indicates whether the ticket holds a callback
+  explicit operator bool() const { return m_callback_ptr != nullptr; }
+
 private:
   //! \brief Store a functor convertible to function pointer
   template <typename F, typename Tk> explicit ticket_with_hook(F &&ftor, Tk) : ticket_with_hook{+ftor, Tk{}} {}
@@ -44,12 +95,18 @@ private:
   template <typename R, typename... Args, typename Tk>
   explicit ticket_with_hook(R (*f_ptr)(Args...), Tk)
       : m_callback_ptr{reinterpret_cast<detail::any_function_t *>(f_ptr)},
-        m_restorer{detail::restore_and_call<R(Args...), Tk>} {}
+        m_restorer{detail::restore_and_call<R(Args...), Tk>},
+        m_frame_restorer{detail::restore_and_call_on_frame<R(Args...), Tk>} {}
 
   detail::any_function_t *m_callback_ptr;
   detail::restorer_t *m_restorer;
+  detail::frame_restorer_t *m_frame_restorer;
 };
 
+//! \brief Ticket of a request which is not answered by the devices
+//! \details Broadcast instructions such as 'instruction::SYNC_WRITE' do not trigger any status packet.
+struct no_response {};
+
 //! \brief Process packets following a sent request
 //! \tparam Signed_Mode Signed integer convention of the received packet
 //! \tparam T Type of the value extracted from the packets
@@ -77,6 +134,20 @@ public:
     return operator<<([&]() { return *it++; });
   }
 
+  //! \copybrief operator<<
+  //! \details
+  //!   The packet has already been parsed (see 'parser'), so the byte stuffing and the CRC are not checked again.
+  //! \param f Parsed packet
+  tl::expected<T, error> operator<<(const frame &f) const {
+    upd::tuple<upd::endianess::LITTLE, Signed_Mode, Ts...> parameters;
+    ASSERT(f.ins == instruction::RETURN, error::NOT_STATUS);
+    ASSERT(f.size == static_cast<std::size_t>(std::distance(parameters.begin(), parameters.end())), error::BAD_LENGTH);
+    ASSERT(f.err.type == error::OK && !f.err.alert, f.err);
+
+    std::copy(f.parameters, f.parameters + f.size, parameters.begin());
+    return parameters.invoke([&](const Ts &...xs) { return T{f.id, xs...}; });
+  }
+
   //! \brief Hook a callback to the ticket
   //! \param hook The callback to store
   //! \return A ticket with the provided hook
@@ -0,0 +1,205 @@
+#include <cstdint>
+#include <vector>
+
+#include <ldp/control_table.hpp>
+#include <ldp/indirect.hpp>
+#include <ldp/shadow.hpp>
+
+#include "utility.hpp"
+
+using torque_enable = ldp::memzone<64, std::uint8_t>;
+using profile_acceleration = ldp::memzone<108, std::uint32_t>;
+using profile_velocity = ldp::memzone<112, std::uint32_t>;
+using goal_position = ldp::memzone<116, std::int32_t>;
+using present_current = ldp::memzone<126, std::int16_t>;
+using present_velocity = ldp::memzone<128, std::int32_t>;
+using present_position = ldp::memzone<132, std::int32_t>;
+
+using xm430 = ldp::control_table<torque_enable, profile_acceleration, profile_velocity, goal_position, present_current,
+                                 present_velocity, present_position>;
+
+static_assert(std::is_same<ldp::detail::plan_t<0, goal_position, torque_enable, profile_velocity>,
+                           ldp::detail::type_list<ldp::detail::window<64, 1, ldp::detail::type_list<torque_enable>>,
+                                                  ldp::detail::window<112, 8,
+                                                                      ldp::detail::type_list<profile_velocity,
+                                                                                             goal_position>>>>::value,
+              "Adjacent memory zones must be grouped together");
+
+static void control_table_DO_read_adjacent_fields_at_once() {
+  using namespace ldp;
+
+  constexpr upd::byte_t expected[] = {0xff, 0xff, 0xfd, 0x00, 0x01, 0x07, 0x00,
+                                      0x02, 0x7e, 0x00, 0x0a, 0x00, 0x36, 0xf9};
+  constexpr upd::byte_t response[] = {0x01, 0x0e, 0x00, 0x55, 0x00, 0xfb, 0xff, 0x14, 0x00, 0x00,
+                                      0x00, 0x00, 0x08, 0x00, 0x00, 0xf4, 0xbe};
+  std::vector<upd::byte_t> buf;
+
+  auto t = xm430::read<present_position, present_current, present_velocity>(0x01) >>
+           [&](upd::byte_t byte) { buf.push_back(byte); };
+  TEST_ASSERT_EQUAL(sizeof expected, buf.size());
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, buf.data(), sizeof expected);
+
+  std::size_t i = 0;
+  auto maybe_data = t << [&]() { return response[i++]; };
+  TEST_ASSERT_TRUE(maybe_data.has_value());
+  TEST_ASSERT_EQUAL(0x01, maybe_data->id);
+  TEST_ASSERT_EQUAL(2048, maybe_data->value.get<present_position>());
+  TEST_ASSERT_EQUAL(20, maybe_data->value.get<present_velocity>());
+  TEST_ASSERT_EQUAL(-5, maybe_data->value.get<present_current>());
+}
+
+static void control_table_DO_read_distant_fields_at_once() {
+  using namespace ldp;
+
+  constexpr upd::byte_t expected[] = {0xff, 0xff, 0xfd, 0x00, 0x01, 0x07, 0x00,
+                                      0x02, 0x40, 0x00, 0x48, 0x00, 0x3a, 0x6d};
+  std::vector<upd::byte_t> buf;
+
+  xm430::read<present_position, torque_enable>(0x01) >> [&](upd::byte_t byte) { buf.push_back(byte); };
+  TEST_ASSERT_EQUAL(sizeof expected, buf.size());
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, buf.data(), sizeof expected);
+}
+
+static void control_table_DO_write_fields_in_contiguous_groups() {
+  using namespace ldp;
+
+  constexpr upd::byte_t expected_first[] = {0xff, 0xff, 0xfd, 0x00, 0x01, 0x06, 0x00,
+                                            0x03, 0x40, 0x00, 0x01, 0xdb, 0x66};
+  constexpr upd::byte_t expected_second[] = {0xff, 0xff, 0xfd, 0x00, 0x01, 0x11, 0x00, 0x03, 0x6c, 0x00, 0x0a, 0x00,
+                                             0x00, 0x00, 0xc8, 0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x16, 0x37};
+  constexpr upd::byte_t response[] = {0x01, 0x04, 0x00, 0x55, 0x00, 0xa1, 0x0c};
+  std::vector<upd::byte_t> buf;
+  auto collect = [&](upd::byte_t byte) { buf.push_back(byte); };
+
+  // Each write instruction is sent once the previous one has been answered
+  fields<goal_position, torque_enable, profile_velocity, profile_acceleration> values{1024, 1, 200, 10};
+  auto writes = xm430::write(0x01, values);
+  static_assert(std::tuple_size<decltype(writes)>::value == 2, "Adjacent fields must be written at once");
+
+  auto t = std::get<0>(writes) >> collect;
+  TEST_ASSERT_EQUAL(sizeof expected_first, buf.size());
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected_first, buf.data(), sizeof expected_first);
+  std::size_t i = 0;
+  auto maybe_id = t << [&]() { return response[i++]; };
+  TEST_ASSERT_TRUE(maybe_id.has_value());
+  TEST_ASSERT_EQUAL(0x01, *maybe_id);
+
+  buf.clear();
+  t = std::get<1>(writes) >> collect;
+  TEST_ASSERT_EQUAL(sizeof expected_second, buf.size());
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected_second, buf.data(), sizeof expected_second);
+}
+
+static void control_table_DO_map_scattered_fields_indirectly() {
+  using namespace ldp;
+  using map_t = x_series_indirect_map<goal_position, present_position, torque_enable>;
+
+  constexpr upd::byte_t expected_setup[] = {0xff, 0xff, 0xfd, 0x00, 0x01, 0x17, 0x00, 0x03, 0xa8, 0x00,
+                                            0x74, 0x00, 0x75, 0x00, 0x76, 0x00, 0x77, 0x00, 0x84, 0x00,
+                                            0x85, 0x00, 0x86, 0x00, 0x87, 0x00, 0x40, 0x00, 0x29, 0xad};
+  constexpr upd::byte_t expected_read[] = {0xff, 0xff, 0xfd, 0x00, 0x01, 0x07, 0x00,
+                                           0x02, 0xe0, 0x00, 0x09, 0x00, 0x0c, 0x6b};
+  constexpr upd::byte_t response[] = {0x01, 0x0d, 0x00, 0x55, 0x00, 0x00, 0x04, 0x00,
+                                      0x00, 0xfe, 0xff, 0xff, 0xff, 0x01, 0x95, 0x50};
+  constexpr upd::byte_t expected_write[] = {0xff, 0xff, 0xfd, 0x00, 0x01, 0x0e, 0x00, 0x03, 0xe0, 0x00, 0x00,
+                                            0x04, 0x00, 0x00, 0xfe, 0xff, 0xff, 0xff, 0x01, 0xce, 0xdb};
+  std::vector<upd::byte_t> buf;
+  auto collect = [&](upd::byte_t byte) { buf.push_back(byte); };
+
+  map_t::setup(0x01) >> collect;
+  TEST_ASSERT_EQUAL(sizeof expected_setup, buf.size());
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected_setup, buf.data(), sizeof expected_setup);
+
+  buf.clear();
+  auto t = map_t::read(0x01) >> collect;
+  TEST_ASSERT_EQUAL(sizeof expected_read, buf.size());
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected_read, buf.data(), sizeof expected_read);
+
+  std::size_t i = 0;
+  auto maybe_data = t << [&]() { return response[i++]; };
+  TEST_ASSERT_TRUE(maybe_data.has_value());
+  TEST_ASSERT_EQUAL(1024, maybe_data->value.get<goal_position>());
+  TEST_ASSERT_EQUAL(-2, maybe_data->value.get<present_position>());
+  TEST_ASSERT_EQUAL(1, maybe_data->value.get<torque_enable>());
+
+  buf.clear();
+  map_t::write(0x01, maybe_data->value) >> collect;
+  TEST_ASSERT_EQUAL(sizeof expected_write, buf.size());
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected_write, buf.data(), sizeof expected_write);
+}
+
+static void control_table_DO_flush_only_the_changed_bytes_of_a_shadow_table() {
+  using namespace ldp;
+
+  constexpr upd::byte_t expected_sync[] = {0xff, 0xff, 0xfd, 0x00, 0xfe, 0x11, 0x00, 0x83, 0x74, 0x00, 0x04, 0x00,
+                                           0x01, 0xe8, 0x03, 0x00, 0x00, 0x02, 0xd0, 0x07, 0x00, 0x00, 0xb5, 0x6b};
+  constexpr upd::byte_t expected_writes[] = {0xff, 0xff, 0xfd, 0x00, 0xfe, 0x0e, 0x00, 0x83, 0x70, 0x00, 0x06, 0x00,
+                                             0x01, 0x2c, 0x01, 0x00, 0x00, 0xdc, 0x05, 0x47, 0xfb, 0xff, 0xff, 0xfd,
+                                             0x00, 0xfe, 0x09, 0x00, 0x83, 0x40, 0x00, 0x01, 0x00, 0x02, 0x01, 0x1d,
+                                             0xd5};
+  constexpr upd::byte_t response[] = {0x01, 0x0e, 0x00, 0x55, 0x00, 0xfb, 0xff, 0x14, 0x00, 0x00,
+                                      0x00, 0x00, 0x08, 0x00, 0x00, 0xf4, 0xbe};
+  std::vector<upd::byte_t> buf;
+  auto collect = [&](upd::byte_t byte) { buf.push_back(byte); };
+
+  shadow_table<xm430, 4> shadow;
+  TEST_ASSERT_TRUE(shadow.set<goal_position>(0x01, 1000));
+  TEST_ASSERT_TRUE(shadow.set<goal_position>(0x02, 2000));
+  TEST_ASSERT_EQUAL(1, shadow.flush(collect));
+  TEST_ASSERT_EQUAL(sizeof expected_sync, buf.size());
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected_sync, buf.data(), sizeof expected_sync);
+
+  buf.clear();
+  shadow.set<goal_position>(0x01, 1000);
+  TEST_ASSERT_FALSE(shadow.dirty(0x01));
+  TEST_ASSERT_EQUAL(0, shadow.flush(collect));
+  TEST_ASSERT_EQUAL(0, buf.size());
+
+  shadow.set<profile_velocity>(0x01, 300);
+  shadow.set<goal_position>(0x01, 1500);
+  shadow.set<torque_enable>(0x02, 1);
+  TEST_ASSERT_EQUAL(2, shadow.flush(collect));
+  TEST_ASSERT_EQUAL(sizeof expected_writes, buf.size());
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected_writes, buf.data(), sizeof expected_writes);
+
+  std::int32_t position = 0;
+  TEST_ASSERT_FALSE(shadow.get<present_position>(0x01, position));
+
+  buf.clear();
+  auto t = shadow.read<present_position, present_current, present_velocity>(0x01) >> collect;
+  std::size_t i = 0;
+  TEST_ASSERT_TRUE((t << [&]() { return response[i++]; }).has_value());
+  TEST_ASSERT_TRUE(shadow.get<present_position>(0x01, position));
+  TEST_ASSERT_EQUAL(2048, position);
+  TEST_ASSERT_TRUE(shadow.get<goal_position>(0x01, position));
+  TEST_ASSERT_EQUAL(1500, position);
+}
+
+static void control_table_DO_send_only_the_written_bytes_of_a_shadow_table() {
+  using namespace ldp;
+  using setpoint = memzone<200, std::uint16_t>;
+  using status = memzone<202, std::uint8_t>;
+  using limit = memzone<203, std::uint16_t>;
+
+  std::size_t count = 0;
+  auto collect = [&](upd::byte_t) { ++count; };
+
+  // The status is only known from the device, so the two changed fields are sent with an instruction each
+  shadow_table<control_table<setpoint, status, limit>, 1> shadow;
+  TEST_ASSERT_TRUE(shadow.store<status>(0x01, 0x20));
+  TEST_ASSERT_TRUE(shadow.set<setpoint>(0x01, 1000));
+  TEST_ASSERT_TRUE(shadow.set<limit>(0x01, 2000));
+  TEST_ASSERT_EQUAL(2, shadow.flush(collect));
+  TEST_ASSERT_EQUAL(2 * 17, count);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(control_table_DO_read_adjacent_fields_at_once);
+  RUN_TEST(control_table_DO_read_distant_fields_at_once);
+  RUN_TEST(control_table_DO_write_fields_in_contiguous_groups);
+  RUN_TEST(control_table_DO_map_scattered_fields_indirectly);
+  RUN_TEST(control_table_DO_flush_only_the_changed_bytes_of_a_shadow_table);
+  RUN_TEST(control_table_DO_send_only_the_written_bytes_of_a_shadow_table);
+  return UNITY_END();
+}
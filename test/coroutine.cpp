@@ -0,0 +1,200 @@
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <vector>
+
+#include <ldp/coroutine.hpp>
+#include <ldp/read.hpp>
+#include <ldp/simulator.hpp>
+#include <ldp/sync_write.hpp>
+#include <ldp/write.hpp>
+
+#include "utility.hpp"
+
+// Coroutine which starts eagerly and whose frame is destroyed when it returns
+struct task {
+  struct promise_type {
+    task get_return_object() { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { std::terminate(); }
+  };
+};
+
+// Coroutine which starts eagerly and whose frame is destroyed by its owner
+struct owned_task {
+  struct promise_type {
+    owned_task get_return_object() { return {std::coroutine_handle<promise_type>::from_promise(*this)}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_always final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { std::terminate(); }
+  };
+
+  std::coroutine_handle<promise_type> handle;
+};
+
+using sim_bus = ldp::async_bus<ldp::simulator>;
+
+// Event loop waking up when the simulator delivers bytes or when the deadline of the request in flight has passed
+static void drive(sim_bus &bus, ldp::simulator &sim) {
+  upd::byte_t buf[16];
+
+  bus.poll(sim.time());
+  while (bus.in_flight()) {
+    auto arrival = sim.next_arrival();
+    if (arrival && *arrival <= bus.deadline()) {
+      auto size = sim.transmit(buf, sizeof buf, *arrival);
+      bus.receive(buf, buf + size, sim.time());
+    } else {
+      bus.poll(bus.deadline());
+    }
+  }
+}
+
+static task move_and_check(sim_bus &bus, ldp::packet_id id, std::int32_t position, std::vector<int> &trace) {
+  using namespace ldp;
+
+  trace.push_back(id);
+  auto written = co_await bus.send(write(id, memzone<116, std::int32_t>{}, position));
+  TEST_ASSERT_TRUE(written.has_value());
+
+  trace.push_back(id);
+  auto maybe_data = co_await bus.send(read(id, memzone<116, std::int32_t>{}));
+  TEST_ASSERT_TRUE(maybe_data.has_value());
+  TEST_ASSERT_EQUAL(id, maybe_data->id);
+  TEST_ASSERT_EQUAL(position, maybe_data->value);
+  trace.push_back(-id);
+}
+
+static task read_twice(sim_bus &bus, std::vector<ldp::error> &errors) {
+  using namespace ldp;
+
+  auto err = co_await bus.send(
+      sync_write(memzone<116, std::int32_t>{}, device_data<std::int32_t>{1, 7}, device_data<std::int32_t>{2, 8}));
+  errors.push_back(err);
+
+  for (int i = 0; i < 2; ++i) {
+    auto maybe_data = co_await bus.send(read(0x01, memzone<116, std::int32_t>{}));
+    errors.push_back(maybe_data ? error{error::OK, false} : maybe_data.error());
+  }
+}
+
+// Deliver the status packet the devices have sent, without letting the deadline pass
+static void deliver(sim_bus &bus, ldp::simulator &sim) {
+  upd::byte_t buf[32];
+  auto arrival = sim.next_arrival();
+  TEST_ASSERT_TRUE(arrival.has_value());
+  auto size = sim.transmit(buf, sizeof buf, *arrival);
+  bus.receive(buf, buf + size, sim.time());
+}
+
+static owned_task read_forever(sim_bus &bus, int &count) {
+  using namespace ldp;
+
+  for (;;) {
+    auto maybe_data = co_await bus.send(read(0x01, memzone<116, std::int32_t>{}));
+    TEST_ASSERT_TRUE(maybe_data.has_value());
+    ++count;
+  }
+}
+
+static void coroutine_DO_pipeline_the_requests_of_several_coroutines() {
+  using namespace ldp;
+
+  simulator sim{1000000};
+  sim.add(0x01);
+  sim.add(0x02);
+  sim_bus bus{sim, std::chrono::milliseconds{1}};
+  std::vector<int> trace;
+
+  move_and_check(bus, 0x01, -1000, trace);
+  move_and_check(bus, 0x02, 2000, trace);
+  TEST_ASSERT_EQUAL(2, bus.pending());
+
+  // The first request is sent, and the control goes back to the event loop until its response is received
+  bus.poll(sim.time());
+  TEST_ASSERT_TRUE(bus.in_flight());
+  TEST_ASSERT_EQUAL(1, bus.pending());
+
+  drive(bus, sim);
+  TEST_ASSERT_EQUAL(0, bus.pending());
+
+  // Both coroutines are suspended on their first request before the bus sends anything
+  const std::vector<int> expected{1, 2, 1, 2, -1, -2};
+  TEST_ASSERT_EQUAL_INT_ARRAY(expected.data(), trace.data(), expected.size());
+  TEST_ASSERT_EQUAL(4, sim.report().instructions);
+}
+
+static void coroutine_DO_resume_with_a_timeout() {
+  using namespace ldp;
+
+  simulator sim;
+  sim.add(0x01);
+  sim.add(0x02);
+  sim.drop_responses(0x01);
+  sim_bus bus{sim, std::chrono::milliseconds{1}};
+  std::vector<error> errors;
+
+  // The sync write has no response, so the first read is sent right after it
+  read_twice(bus, errors);
+  bus.poll(sim.time());
+  TEST_ASSERT_EQUAL(1, errors.size());
+  TEST_ASSERT_TRUE(bus.in_flight());
+  TEST_ASSERT_TRUE(bus.deadline() == sim.time() + std::chrono::milliseconds{1});
+
+  // The first read is not answered, and is only given up once its deadline has passed
+  bus.poll(bus.deadline() - std::chrono::nanoseconds{1});
+  TEST_ASSERT_EQUAL(1, errors.size());
+  drive(bus, sim);
+
+  TEST_ASSERT_EQUAL(3, errors.size());
+  TEST_ASSERT_EQUAL(error::OK, errors[0].type);
+  TEST_ASSERT_EQUAL(error::TIMEOUT, errors[1].type);
+  TEST_ASSERT_EQUAL(error::OK, errors[2].type);
+  TEST_ASSERT_EQUAL(7, sim.memory(0x01)[116]);
+}
+
+static void coroutine_DO_withdraw_the_requests_of_destroyed_coroutines() {
+  using namespace ldp;
+
+  simulator sim;
+  sim.add(0x01);
+  sim_bus bus{sim, std::chrono::milliseconds{1}};
+  int count = 0;
+
+  // The response to the request of a coroutine destroyed while it is in flight is ignored
+  auto sent = read_forever(bus, count);
+  bus.poll(sim.time());
+  TEST_ASSERT_TRUE(bus.in_flight());
+  sent.handle.destroy();
+  TEST_ASSERT_FALSE(bus.in_flight());
+  deliver(bus, sim);
+
+  // The request of a coroutine destroyed while it is queued is never sent
+  auto queued = read_forever(bus, count);
+  auto kept = read_forever(bus, count);
+  TEST_ASSERT_EQUAL(2, bus.pending());
+  queued.handle.destroy();
+  TEST_ASSERT_EQUAL(1, bus.pending());
+
+  bus.poll(sim.time());
+  deliver(bus, sim);
+  TEST_ASSERT_EQUAL(1, count);
+  TEST_ASSERT_TRUE(bus.in_flight());
+  kept.handle.destroy();
+  TEST_ASSERT_FALSE(bus.in_flight());
+
+  // One request of the first coroutine and two of the last one
+  TEST_ASSERT_EQUAL(3, sim.report().instructions);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(coroutine_DO_pipeline_the_requests_of_several_coroutines);
+  RUN_TEST(coroutine_DO_resume_with_a_timeout);
+  RUN_TEST(coroutine_DO_withdraw_the_requests_of_destroyed_coroutines);
+  return UNITY_END();
+}
@@ -0,0 +1,79 @@
+#include <cstddef>
+
+#include <ldp/detail/crc.hpp>
+
+#include "utility.hpp"
+
+static ldp::detail::crc_t reference_crc(const upd::byte_t *begin, const upd::byte_t *end) {
+  using namespace ldp::detail;
+
+  crc_t crc = 0;
+  for (; begin != end; ++begin)
+    crc = (crc << 8u) ^ crc_table[((crc >> 8u) ^ *begin) & 0xff];
+  return crc;
+}
+
+template <typename Engine> static void check_engine() {
+  using namespace ldp::detail;
+
+  upd::byte_t buf[300];
+  std::uint32_t seed = 0x12345678;
+  for (auto &byte : buf) {
+    seed = seed * 1103515245 + 12345;
+    byte = seed >> 16;
+  }
+
+  for (std::size_t offset = 0; offset < 8; ++offset) {
+    for (std::size_t size = 0; size + offset <= sizeof buf; size += 7) {
+      auto begin = buf + offset, end = begin + size;
+      auto expected = reference_crc(begin, end);
+
+      TEST_ASSERT_EQUAL_HEX16(expected, Engine::advance(0, begin, end));
+
+      crc_t crc = 0;
+      for (auto it = begin; it != end; ++it)
+        crc = Engine::advance(crc, *it);
+      TEST_ASSERT_EQUAL_HEX16(expected, crc);
+
+      auto middle = begin + size / 3;
+      TEST_ASSERT_EQUAL_HEX16(expected, Engine::advance(Engine::advance(0, begin, middle), middle, end));
+    }
+  }
+}
+
+static void crc_DO_compute_a_packet_crc() {
+  using namespace ldp::detail;
+
+  constexpr upd::byte_t packet[] = {0xff, 0xff, 0xfd, 0x00, 0x01, 0x03, 0x00, 0x01};
+
+  crc_t crc = 0;
+  advance_crc(crc, packet);
+  TEST_ASSERT_EQUAL_HEX16(0x4e19, crc);
+}
+
+static void crc_DO_compute_the_crc_of_a_char_range() {
+  using namespace ldp::detail;
+
+  constexpr char packet[] = {'\xff', '\xff', '\xfd', '\x00', '\x01', '\x03', '\x00', '\x01'};
+
+  crc_t crc = 0;
+  advance_crc(crc, packet);
+  TEST_ASSERT_EQUAL_HEX16(0x4e19, crc);
+}
+
+static void crc_DO_match_bytewise_with_every_engine() {
+  using namespace ldp::detail;
+
+  check_engine<crc_engine::bytewise>();
+  check_engine<crc_engine::nibble>();
+  check_engine<crc_engine::slicing_by_4>();
+  check_engine<crc_engine::slicing_by_8>();
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(crc_DO_compute_a_packet_crc);
+  RUN_TEST(crc_DO_compute_the_crc_of_a_char_range);
+  RUN_TEST(crc_DO_match_bytewise_with_every_engine);
+  return UNITY_END();
+}
@@ -0,0 +1,110 @@
+#include <cstdint>
+#include <vector>
+
+#include <ldp/bulk.hpp>
+#include <ldp/device.hpp>
+#include <ldp/read.hpp>
+#include <ldp/sync_read.hpp>
+#include <ldp/sync_write.hpp>
+#include <ldp/write.hpp>
+
+#include "utility.hpp"
+
+static void device_DO_decode_instruction_packets() {
+  using namespace ldp;
+
+  std::vector<upd::byte_t> buf(64);
+  auto decode = [&]() { return decode_headerless_instruction(buf.data() + 4, buf.data() + buf.size()); };
+
+  // The written value is serialized as 'ff ff fd 00', so that the packet is stuffed
+  write(0x01, memzone<116, std::uint32_t>{}, 0x00fdffff) >> buf.begin();
+  auto maybe_frame = decode();
+  TEST_ASSERT_TRUE(maybe_frame.has_value());
+  TEST_ASSERT_EQUAL(0x01, maybe_frame->id);
+  TEST_ASSERT_TRUE(maybe_frame->ins == instruction::WRITE);
+  TEST_ASSERT_EQUAL(6, maybe_frame->size);
+
+  auto maybe_access = find_access(*maybe_frame, 0x01);
+  TEST_ASSERT_TRUE(maybe_access.has_value());
+  TEST_ASSERT_EQUAL(memory_access::WRITE, maybe_access->kind);
+  TEST_ASSERT_EQUAL(116, maybe_access->address);
+  TEST_ASSERT_EQUAL(4, maybe_access->length);
+  TEST_ASSERT_TRUE(maybe_access->respond);
+  const upd::byte_t value[] = {0xff, 0xff, 0xfd, 0x00};
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(value, maybe_access->data, sizeof value);
+  TEST_ASSERT_EQUAL(memory_access::NONE, find_access(*maybe_frame, 0x02)->kind);
+
+  sync_write(memzone<116, std::uint32_t>{}, device_data<std::uint32_t>{1, 10}, device_data<std::uint32_t>{2, 20}) >>
+      buf.begin();
+  maybe_access = decode().and_then([](frame f) { return find_access(f, 0x02); });
+  TEST_ASSERT_TRUE(maybe_access.has_value());
+  TEST_ASSERT_EQUAL(memory_access::WRITE, maybe_access->kind);
+  TEST_ASSERT_EQUAL(20, maybe_access->data[0]);
+  TEST_ASSERT_FALSE(maybe_access->respond);
+
+  sync_read(memzone<132, std::uint32_t>{}, 1, 2, 3) >> buf.begin();
+  maybe_access = decode().and_then([](frame f) { return find_access(f, 0x03); });
+  TEST_ASSERT_TRUE(maybe_access.has_value());
+  TEST_ASSERT_EQUAL(memory_access::READ, maybe_access->kind);
+  TEST_ASSERT_EQUAL(132, maybe_access->address);
+  TEST_ASSERT_EQUAL(4, maybe_access->length);
+  TEST_ASSERT_EQUAL(2, maybe_access->rank);
+
+  bulk_read(std::make_pair(1, memzone<132, uint32_t>{}), std::make_pair(2, memzone<65, uint8_t>{})) >> buf.begin();
+  maybe_access = decode().and_then([](frame f) { return find_access(f, 0x02); });
+  TEST_ASSERT_TRUE(maybe_access.has_value());
+  TEST_ASSERT_EQUAL(65, maybe_access->address);
+  TEST_ASSERT_EQUAL(1, maybe_access->length);
+  TEST_ASSERT_EQUAL(1, maybe_access->rank);
+
+  bulk_write(std::make_tuple(1, memzone<116, uint32_t>{}, 512), std::make_tuple(2, memzone<64, uint8_t>{}, 1)) >>
+      buf.begin();
+  maybe_access = decode().and_then([](frame f) { return find_access(f, 0x02); });
+  TEST_ASSERT_TRUE(maybe_access.has_value());
+  TEST_ASSERT_EQUAL(64, maybe_access->address);
+  TEST_ASSERT_EQUAL(1, maybe_access->data[0]);
+
+  // Malformed READ and WRITE instructions are only reported by the device they are addressed to
+  const upd::byte_t truncated[] = {0x84, 0x00, 0x04};
+  frame truncated_read{0x01, instruction::READ, error::OK, truncated, sizeof truncated};
+  TEST_ASSERT_EQUAL(error::DATA_LENGTH, find_access(truncated_read, 0x01).error().type);
+  TEST_ASSERT_EQUAL(memory_access::NONE, find_access(truncated_read, 0x02)->kind);
+  frame truncated_write{0x01, instruction::WRITE, error::OK, truncated, 1};
+  TEST_ASSERT_EQUAL(error::DATA_LENGTH, find_access(truncated_write, 0x01).error().type);
+  TEST_ASSERT_EQUAL(memory_access::NONE, find_access(truncated_write, 0x02)->kind);
+
+  read(0x01, memzone<132, std::int32_t>{}) >> buf.begin();
+  buf[10] ^= 1;
+  TEST_ASSERT_EQUAL(error::RECEIVED_BAD_CRC, decode().error().type);
+  TEST_ASSERT_EQUAL(error::BAD_LENGTH,
+                    decode_headerless_instruction(buf.data() + 4, buf.data() + 10).error().type);
+}
+
+static void device_DO_encode_a_status_packet() {
+  using namespace ldp;
+
+  // The value is serialized as 'ff ff fd 00', so that the packet is stuffed
+  const upd::byte_t data[] = {0xff, 0xff, 0xfd, 0x00};
+  std::vector<upd::byte_t> buf(32);
+
+  auto size = encode_status(buf.data(), buf.size(), 0x01, error{error::OK, false}, data, data + sizeof data);
+  TEST_ASSERT_EQUAL(16, size);
+  auto t = read(0x01, memzone<132, std::uint32_t>{}) >> [](upd::byte_t) {};
+  auto maybe_value = t << buf.begin() + 4;
+  TEST_ASSERT_TRUE(maybe_value.has_value());
+  TEST_ASSERT_EQUAL_UINT32(0x00fdffff, maybe_value->value);
+
+  size = encode_status(buf.data(), buf.size(), 0x01, error{error::DATA_LIMIT, true});
+  TEST_ASSERT_EQUAL(11, size);
+  auto maybe_error = t << buf.begin() + 4;
+  TEST_ASSERT_FALSE(maybe_error.has_value());
+
+  TEST_ASSERT_EQUAL(0, encode_status(buf.data(), 15, 0x01, error{error::OK, false}, data, data + sizeof data));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(device_DO_decode_instruction_packets);
+  RUN_TEST(device_DO_encode_a_status_packet);
+  return UNITY_END();
+}
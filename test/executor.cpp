@@ -0,0 +1,115 @@
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <ldp/executor.hpp>
+#include <ldp/read.hpp>
+#include <ldp/simulator.hpp>
+#include <ldp/sync_read.hpp>
+#include <ldp/write.hpp>
+
+#include "utility.hpp"
+
+static std::vector<ldp::simulator> make_buses() {
+  std::vector<ldp::simulator> retval(2);
+  retval[0].add(0x01);
+  retval[0].add(0x03);
+  retval[1].add(0x02);
+  retval[1].drop_responses(0x02, 1);
+  return retval;
+}
+
+static void executor_DO_run_the_requests_of_every_bus_in_a_cycle() {
+  using namespace ldp;
+
+  executor<simulator, 4> ex{make_buses()};
+  TEST_ASSERT_EQUAL(2, ex.size());
+
+  // The first response of the device on the second bus is dropped
+  auto p_dropped = ex.submit(1, read(0x02, memzone<116, std::int32_t>{}));
+  for (packet_id id : {1, 3})
+    ex.submit(0, write(id, memzone<116, std::int32_t>{}, -100 * id));
+  ex.submit(1, write(0x02, memzone<116, std::int32_t>{}, -200));
+  auto p_read = ex.submit(1, read(0x02, memzone<116, std::int32_t>{}));
+  auto p_sync = ex.submit(0, sync_read(memzone<116, std::int32_t>{}, 1, 3));
+
+  auto cycle = ex.commit();
+  cycle.wait();
+  TEST_ASSERT_TRUE(cycle.ready());
+
+  TEST_ASSERT_EQUAL(error::TIMEOUT, p_dropped.status().type);
+  TEST_ASSERT_EQUAL(error::TIMEOUT, p_dropped.get().error().type);
+
+  auto maybe_data = p_read.get();
+  TEST_ASSERT_TRUE(maybe_data.has_value());
+  TEST_ASSERT_EQUAL(-200, maybe_data->value);
+
+  packet_id ids[2];
+  std::int32_t values[2];
+  error errors[2];
+  TEST_ASSERT_EQUAL(error::OK, p_sync.status().type);
+  TEST_ASSERT_EQUAL(2, p_sync.ticket().receive(p_sync.response(), ids, values, errors));
+  TEST_ASSERT_EQUAL(-100, values[0]);
+  TEST_ASSERT_EQUAL(3, ids[1]);
+  TEST_ASSERT_EQUAL(-300, values[1]);
+
+  TEST_ASSERT_EQUAL(3, ex.statistics(0).jobs.load());
+  TEST_ASSERT_EQUAL(0, ex.statistics(0).timeouts.load());
+  TEST_ASSERT_EQUAL(3, ex.statistics(1).jobs.load());
+  TEST_ASSERT_EQUAL(1, ex.statistics(1).timeouts.load());
+
+  // The workers are asleep by now, and more requests are submitted than the ring of a bus can hold
+  std::this_thread::sleep_for(std::chrono::milliseconds{20});
+  for (int i = 0; i < 10; ++i)
+    p_read = ex.submit(1, read(0x02, memzone<116, std::int32_t>{}));
+  ex.commit().wait();
+  TEST_ASSERT_EQUAL(-200, p_read.get()->value);
+  TEST_ASSERT_EQUAL(13, ex.statistics(1).jobs.load());
+
+  // A barrier does not wait for the requests submitted after it
+  auto before = ex.commit();
+  std::this_thread::sleep_for(std::chrono::milliseconds{20});
+  p_read = ex.submit(1, read(0x02, memzone<116, std::int32_t>{}));
+  auto after = ex.commit();
+  TEST_ASSERT_TRUE(before.ready());
+  after.wait();
+  TEST_ASSERT_EQUAL(-200, p_read.get()->value);
+}
+
+static void executor_DO_receive_the_responses_following_a_missing_one() {
+  using namespace ldp;
+
+  std::vector<simulator> buses(1);
+  for (packet_id id : {1, 2, 3})
+    buses[0].add(id);
+  buses[0].drop_responses(0x02);
+  executor<simulator, 4> ex{std::move(buses)};
+
+  auto p_sync = ex.submit(0, sync_read(memzone<116, std::int32_t>{}, 1, 2, 3));
+  ex.commit().wait();
+
+  // The status packet of the third device is received in place of the second one
+  TEST_ASSERT_EQUAL(error::TIMEOUT, p_sync.status().type);
+  TEST_ASSERT_EQUAL(error::OK, p_sync.status(0).type);
+  TEST_ASSERT_EQUAL(error::OK, p_sync.status(1).type);
+  TEST_ASSERT_EQUAL(error::TIMEOUT, p_sync.status(2).type);
+
+  packet_id ids[3];
+  std::int32_t values[3];
+  error errors[3];
+  TEST_ASSERT_EQUAL(2, p_sync.ticket().receive(p_sync.response(), ids, values, errors));
+  TEST_ASSERT_EQUAL(error::OK, errors[0].type);
+  TEST_ASSERT_EQUAL(error::TIMEOUT, errors[1].type);
+  TEST_ASSERT_EQUAL(error::OK, errors[2].type);
+  TEST_ASSERT_EQUAL(3, ids[2]);
+  TEST_ASSERT_EQUAL(1, ex.statistics(0).timeouts.load());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(executor_DO_run_the_requests_of_every_bus_in_a_cycle);
+  RUN_TEST(executor_DO_receive_the_responses_following_a_missing_one);
+  return UNITY_END();
+}
@@ -0,0 +1,112 @@
+#include <chrono>
+#include <cstddef>
+
+#include <ldp/detail/bus.hpp>
+#include <ldp/instrumentation.hpp>
+#include <ldp/packet.hpp>
+#include <ldp/parser.hpp>
+#include <ldp/ping.hpp>
+#include <ldp/simulator.hpp>
+
+#include "utility.hpp"
+
+static void instrumentation_DO_count_sent_and_received_packets() {
+  using namespace ldp;
+
+  constexpr upd::byte_t parameters[] = {0x00, 0xff, 0xff, 0xfd, 0x12};
+  upd::byte_t packet[32];
+  auto &stats = statistics();
+
+  stats.reset();
+  auto size = write_packet(packet, sizeof packet, upd::two_complement, 0x01, instruction::RETURN, parameters,
+                           parameters + sizeof parameters);
+  TEST_ASSERT_EQUAL(1, stats.sent_by_instruction[0x55].packets.load());
+  TEST_ASSERT_EQUAL(size, stats.sent_by_instruction[0x55].bytes.load());
+  TEST_ASSERT_EQUAL(1, stats.sent_by_device[0x01].packets.load());
+  TEST_ASSERT_EQUAL(1, stats.stuffing_bytes.load());
+
+  std::size_t i = 4;
+  upd::byte_t output[4];
+  TEST_ASSERT_TRUE(read_headerless_packet([&]() { return packet[i++]; }, upd::two_complement, output, output + 4));
+  TEST_ASSERT_EQUAL(1, stats.received_by_device[0x01].packets.load());
+  TEST_ASSERT_EQUAL(size, stats.received_by_device[0x01].bytes.load());
+  TEST_ASSERT_EQUAL(2, stats.stuffing_bytes.load());
+
+  packet[size - 1] ^= 0xff;
+  i = 4;
+  TEST_ASSERT_FALSE(read_headerless_packet([&]() { return packet[i++]; }, upd::two_complement, output, output + 4));
+  TEST_ASSERT_EQUAL(2, stats.received_by_device[0x01].packets.load());
+  TEST_ASSERT_EQUAL(1, stats.errors[error::RECEIVED_BAD_CRC].load());
+}
+
+static void instrumentation_DO_count_parser_errors() {
+  using namespace ldp;
+
+  constexpr upd::byte_t stream[] = {
+      0x12, 0xff, 0xff, 0xff, 0xff, 0xfd, 0x00, 0x01, 0x08, 0x00, 0x55, 0x00, 0xa6, 0x00, 0x00, 0x00,
+      0x8c, 0xc0, 0xff, 0xff, 0xff, 0xfd, 0x00, 0x02, 0x08, 0x00, 0x55, 0x00, 0xf4, 0x01, 0x00, 0x00,
+      0x23, 0x23, 0xff, 0xff, 0xfd, 0x00, 0x03, 0x0a, 0x00, 0x03, 0x74, 0x00, 0xff, 0xff, 0xfd, 0xfd,
+      0x00, 0xa2, 0x4d, 0xff, 0xff, 0xfd, 0x00, 0x04, 0x04, 0x00, 0x55, 0x81, 0x3f, 0x0e};
+  auto &stats = statistics();
+
+  stats.reset();
+  parser<16> p;
+  p.push(stream, stream + sizeof stream, [](tl::expected<frame, error>) {});
+
+  TEST_ASSERT_EQUAL(1, stats.received_by_device[0x01].packets.load());
+  TEST_ASSERT_EQUAL(15, stats.received_by_device[0x01].bytes.load());
+  TEST_ASSERT_EQUAL(0, stats.received_by_device[0x02].packets.load());
+  TEST_ASSERT_EQUAL(1, stats.received_by_device[0x03].packets.load());
+  TEST_ASSERT_EQUAL(1, stats.received_by_device[0x04].packets.load());
+  TEST_ASSERT_EQUAL(1, stats.errors[error::RECEIVED_BAD_CRC].load());
+  TEST_ASSERT_EQUAL(1, stats.errors[error::RESULT_FAIL].load());
+  TEST_ASSERT_EQUAL(1, stats.alerts.load());
+  TEST_ASSERT_EQUAL(1, stats.stuffing_bytes.load());
+
+  // Bytes are skipped before the headers of the first two packets, and before the header of the third one since the
+  // second one is rejected
+  TEST_ASSERT_EQUAL(3, stats.resyncs.load());
+}
+
+static void instrumentation_DO_leave_out_the_packets_of_the_simulated_devices() {
+  using namespace ldp;
+
+  simulator sim;
+  sim.add(0x01);
+  auto &stats = statistics();
+
+  stats.reset();
+  auto t = ping(0x01) >> sim;
+  TEST_ASSERT_TRUE(detail::seek_header(sim, 16));
+  TEST_ASSERT_TRUE((t << sim).has_value());
+
+  TEST_ASSERT_EQUAL(1, stats.sent_by_instruction[0x01].packets.load());
+  TEST_ASSERT_EQUAL(0, stats.sent_by_instruction[0x55].packets.load());
+  TEST_ASSERT_EQUAL(1, stats.received_by_device[0x01].packets.load());
+  TEST_ASSERT_EQUAL(0, stats.resyncs.load());
+}
+
+static void instrumentation_DO_fill_a_latency_histogram() {
+  using namespace ldp;
+
+  latency_histogram<8> histogram;
+  histogram.record(std::chrono::nanoseconds{900});
+  histogram.record(std::chrono::microseconds{5});
+  histogram.record(std::chrono::microseconds{7});
+  histogram.record(std::chrono::seconds{1});
+
+  TEST_ASSERT_EQUAL(1, histogram.count(0));
+  TEST_ASSERT_EQUAL(0, histogram.count(1));
+  TEST_ASSERT_EQUAL(2, histogram.count(2));
+  TEST_ASSERT_EQUAL(1, histogram.count(7));
+  TEST_ASSERT_TRUE(histogram.upper_bound(2) == std::chrono::microseconds{8});
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(instrumentation_DO_count_sent_and_received_packets);
+  RUN_TEST(instrumentation_DO_count_parser_errors);
+  RUN_TEST(instrumentation_DO_leave_out_the_packets_of_the_simulated_devices);
+  RUN_TEST(instrumentation_DO_fill_a_latency_histogram);
+  return UNITY_END();
+}
@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include <ldp/packet.hpp>
 
 #include "utility.hpp"
@@ -15,6 +17,66 @@ static void packet_DO_send_a_packet() {
   TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, buf, sizeof expected);
 }
 
+static void packet_DO_write_a_packet_into_a_buffer() {
+  using namespace ldp;
+
+  constexpr upd::byte_t parameters[] = {0xff, 0xfd, 0xff, 0xff, 0xfd, 0x00, 0xff, 0xff, 0xff, 0xfd, 0xfd, 0x12};
+  upd::byte_t expected[64], *ptr = expected;
+  write_packet([&](upd::byte_t byte) { *ptr++ = byte; }, upd::two_complement, 0x1, instruction::WRITE, parameters,
+               parameters + sizeof parameters);
+
+  upd::byte_t buf[64];
+  auto size = write_packet(buf, sizeof buf, upd::two_complement, 0x1, instruction::WRITE, parameters,
+                           parameters + sizeof parameters);
+
+  TEST_ASSERT_EQUAL(ptr - expected, size);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, buf, size);
+  TEST_ASSERT_EQUAL(0, write_packet(buf, size - 1, upd::two_complement, 0x1, instruction::WRITE, parameters,
+                                    parameters + sizeof parameters));
+
+  // A packet without parameters, such as a ping, may be given an empty null sequence
+  constexpr upd::byte_t ping[] = {0xff, 0xff, 0xfd, 0x0, 0x1, 0x3, 0x0, 0x1, 0x19, 0x4e};
+  TEST_ASSERT_EQUAL(sizeof ping,
+                    write_packet(buf, sizeof buf, upd::two_complement, 0x1, instruction::PING, nullptr, nullptr));
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(ping, buf, sizeof ping);
+}
+
+static void packet_DO_describe_a_packet_as_segments() {
+  using namespace ldp;
+
+  constexpr upd::byte_t parameters[] = {0xff, 0xfd, 0xff, 0xff, 0xfd, 0x00, 0xff, 0xff, 0xff, 0xfd, 0xfd, 0x12};
+  upd::byte_t expected[64], *ptr = expected;
+  write_packet([&](upd::byte_t byte) { *ptr++ = byte; }, upd::two_complement, 0x1, instruction::WRITE, parameters,
+               parameters + sizeof parameters);
+
+  packet_segment segments[8];
+  packet_envelope envelope;
+  auto count = write_packet(segments, 8, envelope, upd::two_complement, 0x1, instruction::WRITE, parameters,
+                            parameters + sizeof parameters);
+
+  // The parameters are split after each of the two sequences 'ff ff fd' and referred to in place
+  TEST_ASSERT_EQUAL(5, count);
+  TEST_ASSERT_TRUE(segments[1].data == parameters);
+  TEST_ASSERT_TRUE(segments[2].data == parameters + 4);
+
+  upd::byte_t buf[64], *end = buf;
+  for (std::size_t i = 0; i < count; ++i)
+    end = std::copy(segments[i].data, segments[i].data + segments[i].size, end);
+  TEST_ASSERT_EQUAL(ptr - expected, end - buf);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, buf, end - buf);
+  TEST_ASSERT_EQUAL(0, write_packet(segments, 4, envelope, upd::two_complement, 0x1, instruction::WRITE, parameters,
+                                    parameters + sizeof parameters));
+
+  // A packet without parameters, such as a ping, may be given an empty null sequence
+  constexpr upd::byte_t ping[] = {0xff, 0xff, 0xfd, 0x0, 0x1, 0x3, 0x0, 0x1, 0x19, 0x4e};
+  count = write_packet(segments, 8, envelope, upd::two_complement, 0x1, instruction::PING, nullptr, nullptr);
+  end = buf;
+  for (std::size_t i = 0; i < count; ++i)
+    end = std::copy(segments[i].data, segments[i].data + segments[i].size, end);
+  TEST_ASSERT_EQUAL(sizeof ping, end - buf);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(ping, buf, sizeof ping);
+}
+
 static void packet_DO_receive_a_headerless_packet() {
   using namespace ldp;
 
@@ -32,6 +94,22 @@ static void packet_DO_receive_a_headerless_packet() {
   TEST_ASSERT_EQUAL_HEX8_ARRAY(input + 9, output, 4);
 }
 
+static void packet_DO_receive_a_stuffed_headerless_packet() {
+  using namespace ldp;
+
+  constexpr upd::byte_t parameters[] = {0x00, 0xff, 0xff, 0xfd, 0x12};
+  upd::byte_t input[32];
+  auto size = write_packet(input, sizeof input, upd::two_complement, 0x1, instruction::RETURN, parameters,
+                           parameters + sizeof parameters);
+  upd::byte_t output[4] = {};
+  const upd::byte_t *ptr = input + 4;
+
+  auto maybe_id = read_headerless_packet([&]() { return *ptr++; }, upd::two_complement, output, output + 4);
+  TEST_ASSERT_TRUE(maybe_id.has_value());
+  TEST_ASSERT_EQUAL(size, ptr - input);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(parameters + 1, output, 4);
+}
+
 static void packet_DO_receive_a_headerless_packet_shorter_than_expected() {
   using namespace ldp;
 
@@ -60,11 +138,40 @@ static void packet_DO_receive_a_headerless_packet_bigger_than_expected() {
       .map_error([&](error e) { TEST_ASSERT_EQUAL(error::BAD_LENGTH, e.type); });
 }
 
+static void packet_DO_receive_a_headerless_fast_sync_packet() {
+  using namespace ldp;
+
+  constexpr upd::byte_t input[] = {0xfe, 0x1a, 0x00, 0x55, 0x00, 0x01, 0xa6, 0x00, 0x00, 0x00, 0xd7,
+                                   0x82, 0x00, 0x02, 0xff, 0xff, 0xfd, 0xfd, 0x00, 0x2d, 0xe6, 0x84,
+                                   0x03, 0x10, 0x00, 0x00, 0x00, 0x22, 0xd5};
+  constexpr upd::byte_t expected[] = {0xa6, 0x00, 0x00, 0x00, 0xff, 0xff, 0xfd, 0x00, 0x10, 0x00, 0x00, 0x00};
+  packet_id ids[3];
+  error errors[3];
+  upd::byte_t output[12];
+  const upd::byte_t *ptr = input;
+  auto read = [&]() { return *ptr++; };
+
+  read_headerless_fast_sync_packet(read, upd::two_complement, ids, errors, 3, output, output + sizeof output)
+      .map([&](std::size_t count) { TEST_ASSERT_EQUAL(2, count); })
+      .map_error([&](error) { TEST_FAIL(); });
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, output, sizeof expected);
+  TEST_ASSERT_EQUAL(ptr - input, sizeof input);
+
+  ptr = input;
+  read_headerless_fast_sync_packet(read, upd::two_complement, ids, errors, 2, output, output + 8)
+      .map([&](std::size_t) { TEST_FAIL(); })
+      .map_error([&](error e) { TEST_ASSERT_EQUAL(error::BAD_LENGTH, e.type); });
+}
+
 int main() {
   UNITY_BEGIN();
   RUN_TEST(packet_DO_send_a_packet);
+  RUN_TEST(packet_DO_write_a_packet_into_a_buffer);
+  RUN_TEST(packet_DO_describe_a_packet_as_segments);
   RUN_TEST(packet_DO_receive_a_headerless_packet);
+  RUN_TEST(packet_DO_receive_a_stuffed_headerless_packet);
   RUN_TEST(packet_DO_receive_a_headerless_packet_shorter_than_expected);
   RUN_TEST(packet_DO_receive_a_headerless_packet_bigger_than_expected);
+  RUN_TEST(packet_DO_receive_a_headerless_fast_sync_packet);
   return UNITY_END();
 }
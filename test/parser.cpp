@@ -0,0 +1,123 @@
+#include <cstddef>
+
+#include <ldp/parser.hpp>
+
+#include "utility.hpp"
+
+constexpr upd::byte_t stream[] = {
+    0x12, 0xff, 0xff, 0xff, 0xff, 0xfd, 0x00, 0x01, 0x08, 0x00, 0x55, 0x00, 0xa6, 0x00, 0x00, 0x00,
+    0x8c, 0xc0, 0xff, 0xff, 0xff, 0xfd, 0x00, 0x02, 0x08, 0x00, 0x55, 0x00, 0xf4, 0x01, 0x00, 0x00,
+    0x23, 0x23, 0xff, 0xff, 0xfd, 0x00, 0x03, 0x0a, 0x00, 0x03, 0x74, 0x00, 0xff, 0xff, 0xfd, 0xfd,
+    0x00, 0xa2, 0x4d, 0xff, 0xff, 0xfd, 0x00, 0x04, 0x04, 0x00, 0x55, 0x81, 0x3f, 0x0e};
+
+static void parser_DO_parse_a_stream_in_chunks() {
+  using namespace ldp;
+
+  for (std::size_t chunk = 1; chunk <= sizeof stream; ++chunk) {
+    parser<16> p;
+    std::size_t count = 0;
+
+    auto callback = [&](tl::expected<frame, error> maybe_frame) {
+      switch (count++) {
+      case 0:
+        TEST_ASSERT_TRUE(maybe_frame.has_value());
+        TEST_ASSERT_EQUAL(0x01, maybe_frame->id);
+        TEST_ASSERT_EQUAL(error::OK, maybe_frame->err.type);
+        TEST_ASSERT_EQUAL(4, maybe_frame->size);
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(stream + 12, maybe_frame->parameters, 4);
+        break;
+      case 1:
+        TEST_ASSERT_FALSE(maybe_frame.has_value());
+        TEST_ASSERT_EQUAL(error::RECEIVED_BAD_CRC, maybe_frame.error().type);
+        break;
+      case 2: {
+        constexpr upd::byte_t expected[] = {0x74, 0x00, 0xff, 0xff, 0xfd, 0x00};
+        TEST_ASSERT_TRUE(maybe_frame.has_value());
+        TEST_ASSERT_EQUAL(0x03, maybe_frame->id);
+        TEST_ASSERT_TRUE(maybe_frame->ins == instruction::WRITE);
+        TEST_ASSERT_EQUAL(sizeof expected, maybe_frame->size);
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, maybe_frame->parameters, sizeof expected);
+        break;
+      }
+      case 3:
+        TEST_ASSERT_TRUE(maybe_frame.has_value());
+        TEST_ASSERT_EQUAL(0x04, maybe_frame->id);
+        TEST_ASSERT_EQUAL(error::RESULT_FAIL, maybe_frame->err.type);
+        TEST_ASSERT_TRUE(maybe_frame->err.alert);
+        TEST_ASSERT_EQUAL(0, maybe_frame->size);
+        break;
+      default:
+        TEST_FAIL();
+      }
+    };
+
+    for (auto it = stream; it < stream + sizeof stream; it += chunk) {
+      auto end = it + chunk < stream + sizeof stream ? it + chunk : stream + sizeof stream;
+      p.push(it, end, callback);
+    }
+
+    TEST_ASSERT_EQUAL(4, count);
+  }
+}
+
+static void parser_DO_resynchronize_after_an_oversized_packet() {
+  using namespace ldp;
+
+  parser<4> p;
+  std::size_t frames = 0, errors = 0;
+  p.push(stream + 34, stream + sizeof stream, [&](tl::expected<frame, error> maybe_frame) {
+    if (maybe_frame) {
+      TEST_ASSERT_EQUAL(0x04, maybe_frame->id);
+      ++frames;
+    } else {
+      TEST_ASSERT_EQUAL(error::BAD_LENGTH, maybe_frame.error().type);
+      ++errors;
+    }
+  });
+
+  TEST_ASSERT_EQUAL(1, frames);
+  TEST_ASSERT_EQUAL(1, errors);
+}
+
+static void parser_DO_recover_the_packets_swallowed_by_a_corrupted_length() {
+  using namespace ldp;
+
+  constexpr upd::byte_t parameters[] = {0x00, 0x01, 0x02, 0x03, 0x04};
+  upd::byte_t input[64];
+  std::size_t size = 0;
+  for (packet_id id = 1; id <= 3; ++id)
+    size += write_packet(input + size, sizeof input - size, upd::two_complement, id, instruction::RETURN, parameters,
+                         parameters + sizeof parameters);
+
+  // The field 'Length' of the first packet covers the second packet and most of the third one
+  input[5] = 0x20;
+
+  parser<64> p;
+  std::size_t count = 0;
+  p.push(input, input + size, [&](tl::expected<frame, error> maybe_frame) {
+    switch (count++) {
+    case 0:
+      TEST_ASSERT_FALSE(maybe_frame.has_value());
+      TEST_ASSERT_EQUAL(error::RECEIVED_BAD_CRC, maybe_frame.error().type);
+      break;
+    case 1:
+    case 2:
+      TEST_ASSERT_TRUE(maybe_frame.has_value());
+      TEST_ASSERT_EQUAL(count, maybe_frame->id);
+      TEST_ASSERT_EQUAL_HEX8_ARRAY(parameters + 1, maybe_frame->parameters, 4);
+      break;
+    default:
+      TEST_FAIL();
+    }
+  });
+
+  TEST_ASSERT_EQUAL(3, count);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(parser_DO_parse_a_stream_in_chunks);
+  RUN_TEST(parser_DO_resynchronize_after_an_oversized_packet);
+  RUN_TEST(parser_DO_recover_the_packets_swallowed_by_a_corrupted_length);
+  return UNITY_END();
+}
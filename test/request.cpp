@@ -1,7 +1,13 @@
 #include <vector>
 
+#include <ldp/batch.hpp>
+#include <ldp/bulk.hpp>
 #include <ldp/ping.hpp>
+#include <ldp/prepared.hpp>
 #include <ldp/read.hpp>
+#include <ldp/static_request.hpp>
+#include <ldp/sync_read.hpp>
+#include <ldp/sync_write.hpp>
 #include <ldp/write.hpp>
 
 #include "utility.hpp"
@@ -38,6 +44,35 @@ static void request_DO_send_a_request_with_hook() {
   TEST_ASSERT_EQUAL(error::OK, t_wh(mb.buf.begin()).type);
 }
 
+static void request_DO_call_a_hook_on_a_contiguous_packet() {
+  using namespace ldp;
+
+  const upd::byte_t response[] = {0x01, 0x07, 0x00, 0x55, 0x00, 0x06, 0x04, 0x26, 0x65, 0x5d};
+  const upd::byte_t oversized[] = {0x01, 0xff, 0xff, 0x55};
+
+  static int calls;
+  auto t_wh = ping(0x01).write([](upd::byte_t) {}).with_hook([](const device_info &info) {
+    TEST_ASSERT_EQUAL(0x01, info.id);
+    TEST_ASSERT_EQUAL(1030, info.model_number);
+    ++calls;
+  });
+
+  calls = 0;
+  TEST_ASSERT_EQUAL(error::OK, t_wh(response, response + sizeof response).type);
+  TEST_ASSERT_EQUAL(error::RECEIVED_BAD_CRC, t_wh(response, response + sizeof response - 1).type);
+  TEST_ASSERT_EQUAL(1, calls);
+
+  std::size_t consumed = 0;
+  auto read_oversized = [&]() -> upd::byte_t {
+    auto byte = consumed < sizeof oversized ? oversized[consumed] : upd::byte_t{0};
+    ++consumed;
+    return byte;
+  };
+  TEST_ASSERT_EQUAL(error::BAD_LENGTH, t_wh(read_oversized).type);
+  TEST_ASSERT_EQUAL(3, consumed);
+  TEST_ASSERT_EQUAL(1, calls);
+}
+
 static void request_DO_send_a_ping_request() {
   using namespace ldp;
 
@@ -85,11 +120,282 @@ static void request_DO_send_a_read_request() {
       .or_else([](error) { TEST_FAIL(); });
 }
 
+static void request_DO_send_a_sync_write_request() {
+  using namespace ldp;
+
+  std::vector<upd::byte_t> expected{0xff, 0xff, 0xfd, 0x00, 0xfe, 0x11, 0x00, 0x83, 0x74, 0x00, 0x04, 0x00,
+                                    0x01, 0x96, 0x00, 0x00, 0x00, 0x02, 0xaa, 0x00, 0x00, 0x00, 0x82, 0x87};
+  std::vector<upd::byte_t> buf(64);
+
+  sync_write(memzone<116, uint32_t>{}, device_data<int>{1, 150}, device_data<int>{2, 170}) >> buf.begin();
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected.data(), buf.data(), expected.size());
+
+  std::vector<device_data<uint32_t>> entries{{1, 150}, {2, 170}};
+  buf.assign(64, 0);
+  sync_write(memzone<116, uint32_t>{}, entries.begin(), entries.end()) >> buf.begin();
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected.data(), buf.data(), expected.size());
+}
+
+static void request_DO_send_a_sync_read_request() {
+  using namespace ldp;
+
+  mock_bus mb{{0xff, 0xff, 0xfd, 0x00, 0xfe, 0x0a, 0x00, 0x82, 0x84, 0x00, 0x04, 0x00, 0x01, 0x02, 0x03, 0x2a, 0x6c},
+              {0x01, 0x08, 0x00, 0x55, 0x00, 0xa6, 0x00, 0x00, 0x00, 0x8c, 0xc0, 0xff, 0xff, 0xfd, 0x00, 0x02,
+               0x08, 0x00, 0x55, 0x00, 0xf4, 0x01, 0x00, 0x00, 0x23, 0x00, 0xff, 0xff, 0xfd, 0x00, 0x03, 0x08,
+               0x00, 0x55, 0x84, 0x10, 0x00, 0x00, 0x00, 0x9a, 0x49}};
+
+  auto t = sync_read(memzone<132, uint32_t>{}, 1, 2, 3) >> mb.buf.begin();
+  mb.shift();
+
+  packet_id ids[3];
+  uint32_t values[3];
+  error errors[3];
+  TEST_ASSERT_EQUAL(1, t.receive(mb.buf.begin(), ids, values, errors));
+
+  TEST_ASSERT_EQUAL(error::OK, errors[0].type);
+  TEST_ASSERT_EQUAL(0x01, ids[0]);
+  TEST_ASSERT_EQUAL_UINT32(166, values[0]);
+  TEST_ASSERT_EQUAL(error::RECEIVED_BAD_CRC, errors[1].type);
+  TEST_ASSERT_EQUAL(error::DATA_RANGE, errors[2].type);
+  TEST_ASSERT_TRUE(errors[2].alert);
+}
+
+static void request_DO_bound_the_bytes_read_for_a_sync_read_request() {
+  using namespace ldp;
+
+  std::vector<upd::byte_t> buf(64, 0);
+  auto t = sync_read(memzone<132, uint32_t>{}, 1, 2, 3) >> buf.begin();
+
+  // Each packet after the first one is preceded by as many bytes as the search skips
+  std::vector<upd::byte_t> input{0x01, 0x08, 0x00, 0x55, 0x00, 0xa6, 0x00, 0x00, 0x00, 0x8c, 0xc0};
+  for (int i = 0; i < 2; ++i) {
+    input.insert(input.end(), detail::max_status_size(sizeof(uint32_t)) - sizeof detail::header, 0x00);
+    input.insert(input.end(), {0xff, 0xff, 0xfd, 0x00, 0x03, 0x08, 0x00, 0x55, 0x84, 0x10, 0x00, 0x00, 0x00, 0x9a, 0x49});
+  }
+
+  std::size_t read = 0;
+  auto ftor = [&]() { return input.at(read++); };
+
+  packet_id ids[3];
+  uint32_t values[3];
+  error errors[3];
+  TEST_ASSERT_EQUAL(1, t.receive(ftor, ids, values, errors));
+  TEST_ASSERT_EQUAL(error::DATA_RANGE, errors[1].type);
+  TEST_ASSERT_EQUAL(error::DATA_RANGE, errors[2].type);
+  TEST_ASSERT_EQUAL(input.size(), read);
+  TEST_ASSERT_TRUE(sizeof detail::header + read <= decltype(t)::max_size);
+}
+
+static void request_DO_send_a_fast_sync_read_request() {
+  using namespace ldp;
+
+  mock_bus mb{{0xff, 0xff, 0xfd, 0x00, 0xfe, 0x0a, 0x00, 0x8a, 0x84, 0x00, 0x04, 0x00, 0x01, 0x02, 0x03, 0x1a, 0xec},
+              {0xfe, 0x1a, 0x00, 0x55, 0x00, 0x01, 0xa6, 0x00, 0x00, 0x00, 0xd7, 0x82, 0x00, 0x02, 0xff, 0xff, 0xfd,
+               0xfd, 0x00, 0x2d, 0xe6, 0x84, 0x03, 0x10, 0x00, 0x00, 0x00, 0x22, 0xd5}};
+
+  auto t = fast_sync_read(memzone<132, uint32_t>{}, 1, 2, 3) >> mb.buf.begin();
+  mb.shift();
+
+  packet_id ids[3];
+  uint32_t values[3];
+  error errors[3];
+  TEST_ASSERT_EQUAL(2, t.receive(mb.buf.begin(), ids, values, errors));
+
+  packet_id expected_ids[] = {1, 2, 3};
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected_ids, ids, 3);
+  TEST_ASSERT_EQUAL(error::OK, errors[0].type);
+  TEST_ASSERT_EQUAL_UINT32(166, values[0]);
+  TEST_ASSERT_EQUAL(error::OK, errors[1].type);
+  TEST_ASSERT_EQUAL_UINT32(0xfdffff, values[1]);
+  TEST_ASSERT_EQUAL(error::DATA_RANGE, errors[2].type);
+  TEST_ASSERT_TRUE(errors[2].alert);
+
+  mb.buf[20] = 0xe7;
+  mb.buf[27] = 0x31;
+  mb.buf[28] = 0x54;
+  TEST_ASSERT_EQUAL(1, t.receive(mb.buf.begin(), ids, values, errors));
+  TEST_ASSERT_EQUAL(error::RECEIVED_BAD_CRC, errors[1].type);
+  TEST_ASSERT_EQUAL(error::DATA_RANGE, errors[2].type);
+}
+
+static void request_DO_send_a_bulk_read_request() {
+  using namespace ldp;
+
+  mock_bus mb{{0xff, 0xff, 0xfd, 0x00, 0xfe, 0x0d, 0x00, 0x92, 0x01, 0x84, 0x00, 0x04, 0x00, 0x02, 0x41, 0x00, 0x01,
+               0x00, 0xde, 0x00},
+              {0x01, 0x08, 0x00, 0x55, 0x00, 0xa6, 0x00, 0x00, 0x00, 0x8c, 0xc0, 0xff, 0xff, 0xfd,
+               0x00, 0x02, 0x05, 0x00, 0x55, 0x00, 0x01, 0x56, 0x29}};
+
+  auto t = bulk_read(std::make_pair(1, memzone<132, uint32_t>{}), std::make_pair(2, memzone<65, uint8_t>{})) >>
+           mb.buf.begin();
+  mb.shift();
+  auto response = t << mb.buf.begin();
+
+  std::get<0>(response)
+      .map([](device_data<uint32_t> data) {
+        TEST_ASSERT_EQUAL(0x01, data.id);
+        TEST_ASSERT_EQUAL_UINT32(166, data.value);
+      })
+      .or_else([](error) { TEST_FAIL(); });
+  std::get<1>(response)
+      .map([](device_data<uint8_t> data) {
+        TEST_ASSERT_EQUAL(0x02, data.id);
+        TEST_ASSERT_EQUAL_UINT8(1, data.value);
+      })
+      .or_else([](error) { TEST_FAIL(); });
+}
+
+static void request_DO_send_a_bulk_write_request() {
+  using namespace ldp;
+
+  std::vector<upd::byte_t> expected{0xff, 0xff, 0xfd, 0x00, 0xfe, 0x12, 0x00, 0x93, 0x01, 0x74, 0x00, 0x04, 0x00,
+                                    0x00, 0x02, 0x00, 0x00, 0x02, 0x40, 0x00, 0x01, 0x00, 0x01, 0xd4, 0x5e};
+  std::vector<upd::byte_t> buf(64);
+
+  bulk_write(std::make_tuple(1, memzone<116, uint32_t>{}, 512), std::make_tuple(2, memzone<64, uint8_t>{}, 1)) >>
+      buf.begin();
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected.data(), buf.data(), expected.size());
+}
+
+static void request_DO_decode_a_batch_of_responses() {
+  using namespace ldp;
+
+  constexpr upd::byte_t input[] = {
+      0xff, 0xff, 0xfd, 0x00, 0x01, 0x07, 0x00, 0x55, 0x00, 0x06, 0x04, 0x26, 0x65, 0x5d, 0x12, 0xff, 0xff,
+      0xfd, 0x00, 0x02, 0x07, 0x00, 0x55, 0x00, 0x06, 0x04, 0x27, 0x6a, 0xed, 0xff, 0xff, 0xfd, 0x00, 0x03,
+      0x07, 0x00, 0x55, 0x00, 0x06, 0x04, 0x26, 0x96, 0x7d, 0xff, 0xff, 0xfd, 0x00, 0x04, 0x07, 0x00, 0x55,
+      0x80, 0x60, 0x04, 0x2d, 0x85, 0x0a, 0xff, 0xff, 0xfd, 0x00, 0x05, 0x07, 0x00, 0x55, 0x00};
+
+  device_info infos[8];
+  error errors[8];
+  auto result = decode_batch(ticket<upd::signed_mode::TWO_COMPLEMENT, device_info, std::uint16_t, std::uint8_t>{},
+                             input, input + sizeof input, infos, errors, 8);
+
+  TEST_ASSERT_EQUAL(4, result.count);
+  TEST_ASSERT_EQUAL(57, result.consumed);
+  TEST_ASSERT_EQUAL(error::OK, errors[0].type);
+  TEST_ASSERT_EQUAL(0x01, infos[0].id);
+  TEST_ASSERT_EQUAL(error::OK, errors[1].type);
+  TEST_ASSERT_EQUAL(0x02, infos[1].id);
+  TEST_ASSERT_EQUAL(39, infos[1].firmware_version);
+  TEST_ASSERT_EQUAL(error::RECEIVED_BAD_CRC, errors[2].type);
+  TEST_ASSERT_TRUE(errors[3].alert);
+
+  result = decode_batch(ticket<upd::signed_mode::TWO_COMPLEMENT, device_info, std::uint16_t, std::uint8_t>{}, input,
+                        input + sizeof input, infos, errors, 2);
+  TEST_ASSERT_EQUAL(2, result.count);
+  TEST_ASSERT_EQUAL(29, result.consumed);
+
+  // A corrupted field 'Length' does not stall the buffer
+  upd::byte_t corrupted[sizeof input];
+  std::copy(input, input + sizeof input, corrupted);
+  corrupted[20] = 0xff;
+  corrupted[21] = 0xff;
+  result = decode_batch(ticket<upd::signed_mode::TWO_COMPLEMENT, device_info, std::uint16_t, std::uint8_t>{}, corrupted,
+                        corrupted + sizeof corrupted, infos, errors, 8);
+  TEST_ASSERT_EQUAL(4, result.count);
+  TEST_ASSERT_EQUAL(57, result.consumed);
+  TEST_ASSERT_EQUAL(error::OK, errors[0].type);
+  TEST_ASSERT_EQUAL(error::BAD_LENGTH, errors[1].type);
+  TEST_ASSERT_EQUAL(error::RECEIVED_BAD_CRC, errors[2].type);
+}
+
+static void request_DO_patch_a_prepared_request() {
+  using namespace ldp;
+
+  std::vector<upd::byte_t> expected, buf;
+  auto collect = [](std::vector<upd::byte_t> &v) {
+    v.clear();
+    return [&v](upd::byte_t byte) { v.push_back(byte); };
+  };
+
+  auto pw = prepare_write(0x01, memzone<116, uint32_t>{}, 512);
+  auto psw = prepare_sync_write(memzone<116, uint32_t>{}, device_data<int>{1, 150}, device_data<int>{2, 170});
+  sync_write(memzone<116, uint32_t>{}, device_data<int>{1, 150}, device_data<int>{2, 170}) >> collect(expected);
+  psw >> collect(buf);
+  TEST_ASSERT_EQUAL(expected.size(), buf.size());
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected.data(), buf.data(), expected.size());
+
+  // Some values are serialized as 'ff ff fd', so that the packet is stuffed then unstuffed
+  uint32_t values[] = {512, 0x00fdffff, 0x12345678, 0xfdffff00, 0xffffffff, 0, 0xfd, 0x00fdffff, 1};
+  for (auto value : values) {
+    pw.set<1>(value);
+    write(0x01, memzone<116, uint32_t>{}, value) >> collect(expected);
+    pw >> collect(buf);
+    TEST_ASSERT_EQUAL(expected.size(), buf.size());
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected.data(), buf.data(), expected.size());
+
+    psw.set<3>(value);
+    psw.set<5>(value ^ 0xff);
+    sync_write(memzone<116, uint32_t>{}, device_data<uint32_t>{1, value}, device_data<uint32_t>{2, value ^ 0xff}) >>
+        collect(expected);
+    TEST_ASSERT_EQUAL(expected.size(), psw.size());
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected.data(), psw.data(), expected.size());
+  }
+}
+
+static_assert(
+    std::is_same<ldp::static_ping_t<upd::signed_mode::TWO_COMPLEMENT, 0x01>,
+                 ldp::static_request<
+                     ldp::ticket<upd::signed_mode::TWO_COMPLEMENT, ldp::device_info, std::uint16_t, std::uint8_t>,
+                     ldp::detail::byte_sequence<0xff, 0xff, 0xfd, 0x00, 0x01, 0x03, 0x00, 0x01, 0x19, 0x4e>>>::value,
+    "Bad static ping packet");
+static_assert(std::is_same<decltype(ldp::static_read<0x01>(ldp::memzone<132, uint32_t>{})),
+                           ldp::static_request<ldp::ticket<upd::signed_mode::TWO_COMPLEMENT,
+                                                           ldp::device_data<uint32_t>, uint32_t>,
+                                               ldp::detail::byte_sequence<0xff, 0xff, 0xfd, 0x00, 0x01, 0x07, 0x00,
+                                                                          0x02, 0x84, 0x00, 0x04, 0x00, 0x1d,
+                                                                          0x15>>>::value,
+              "Bad static read packet");
+
+static void request_DO_send_a_static_request() {
+  using namespace ldp;
+
+  std::vector<upd::byte_t> expected, buf;
+  auto ping_bytes = static_ping<0x01>().bytes;
+  ping(0x01) >> [&](upd::byte_t byte) { expected.push_back(byte); };
+  TEST_ASSERT_EQUAL(expected.size(), ping_bytes.size());
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected.data(), ping_bytes.data(), expected.size());
+
+  expected.clear();
+  auto read_request = static_read<0x01>(memzone<132, uint32_t>{});
+  read(0x01, memzone<132, uint32_t>{}) >> [&](upd::byte_t byte) { expected.push_back(byte); };
+  auto t = read_request >> [&](upd::byte_t byte) { buf.push_back(byte); };
+  TEST_ASSERT_EQUAL(expected.size(), buf.size());
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected.data(), buf.data(), expected.size());
+
+  constexpr upd::byte_t response[] = {0x01, 0x08, 0x00, 0x55, 0x00, 0xa6, 0x00, 0x00, 0x00, 0x8c, 0xc0};
+  std::size_t i = 0;
+  auto maybe_data = t << [&]() { return response[i++]; };
+  TEST_ASSERT_TRUE(maybe_data.has_value());
+  TEST_ASSERT_EQUAL_UINT32(166, maybe_data->value);
+
+  // The parameters 0xffff and 0xfd are serialized as 'ff ff fd 00', so a stuffing byte is expected
+  constexpr upd::byte_t parameters[] = {0xff, 0xff, 0xfd, 0x00};
+  upd::byte_t stuffed[32];
+  auto size = write_packet(stuffed, sizeof stuffed, upd::two_complement, 0x01, instruction::READ, parameters,
+                           parameters + sizeof parameters);
+  using stuffed_t = detail::static_packet<0x01, instruction::READ, detail::byte_sequence<0xff, 0xff, 0xfd, 0x00>>::type;
+  auto stuffed_bytes = static_request<ticket<upd::signed_mode::TWO_COMPLEMENT, device_info>, stuffed_t>::bytes;
+  TEST_ASSERT_EQUAL(size, stuffed_bytes.size());
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(stuffed, stuffed_bytes.data(), size);
+}
+
 int main() {
   UNITY_BEGIN();
   RUN_TEST(request_DO_send_a_request_with_hook);
+  RUN_TEST(request_DO_call_a_hook_on_a_contiguous_packet);
   RUN_TEST(request_DO_send_a_ping_request);
   RUN_TEST(request_DO_send_a_write_request);
   RUN_TEST(request_DO_send_a_read_request);
+  RUN_TEST(request_DO_send_a_static_request);
+  RUN_TEST(request_DO_patch_a_prepared_request);
+  RUN_TEST(request_DO_send_a_sync_write_request);
+  RUN_TEST(request_DO_send_a_sync_read_request);
+  RUN_TEST(request_DO_bound_the_bytes_read_for_a_sync_read_request);
+  RUN_TEST(request_DO_send_a_fast_sync_read_request);
+  RUN_TEST(request_DO_send_a_bulk_read_request);
+  RUN_TEST(request_DO_send_a_bulk_write_request);
+  RUN_TEST(request_DO_decode_a_batch_of_responses);
   return UNITY_END();
 }
@@ -0,0 +1,179 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+// Both sides of the ring are threads in the stress test, which may share a single core
+#define LDP_RING_RELAX() std::this_thread::yield()
+
+#include <ldp/detail/bus.hpp>
+#include <ldp/device.hpp>
+#include <ldp/read.hpp>
+#include <ldp/ring.hpp>
+#include <ldp/sentry.hpp>
+
+#include "utility.hpp"
+
+static void ring_DO_expose_two_regions_when_wrapping_around() {
+  using namespace ldp;
+
+  static byte_ring<8> ring;
+  const upd::byte_t input[] = {1, 2, 3, 4, 5, 6};
+  upd::byte_t output[8];
+
+  TEST_ASSERT_EQUAL(6, ring.push(input, input + sizeof input));
+  TEST_ASSERT_EQUAL(5, ring.pop(output, 5));
+  TEST_ASSERT_EQUAL(5, ring.push(input, input + 5));
+  TEST_ASSERT_EQUAL(2, ring.push(input, input + sizeof input));
+  TEST_ASSERT_FALSE(ring.push(0));
+  TEST_ASSERT_EQUAL(0, ring.write_region().size());
+
+  auto region = ring.read_region();
+  TEST_ASSERT_EQUAL(3, region.first.size);
+  TEST_ASSERT_EQUAL(5, region.second.size);
+  const upd::byte_t expected[] = {6, 1, 2, 3, 4, 5, 1, 2};
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, region.first.data, region.first.size);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected + 3, region.second.data, region.second.size);
+
+  ring.consume(4);
+  region = ring.write_region();
+  TEST_ASSERT_EQUAL(4, region.size());
+  region.first.data[0] = 42;
+  ring.commit(1);
+  TEST_ASSERT_EQUAL(5, ring.size());
+  TEST_ASSERT_EQUAL(5, ring.pop(output, sizeof output));
+  TEST_ASSERT_EQUAL(42, output[4]);
+  TEST_ASSERT_TRUE(ring.empty());
+
+  upd::byte_t byte;
+  TEST_ASSERT_FALSE(ring.pop(byte));
+}
+
+static void ring_DO_carry_a_request_and_its_response() {
+  using namespace ldp;
+
+  static byte_ring<64> ring;
+  upd::byte_t packet[32];
+
+  auto t = read(0x01, memzone<132, std::int32_t>{}) >> ring;
+  const upd::byte_t expected[] = {0xff, 0xff, 0xfd, 0x00, 0x01, 0x07, 0x00, 0x02, 0x84, 0x00, 0x04, 0x00, 0x1d, 0x15};
+  TEST_ASSERT_EQUAL(sizeof expected, ring.pop(packet, sizeof packet));
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, packet, sizeof expected);
+
+  const upd::byte_t data[] = {0x00, 0xff, 0xff, 0xfd};
+  auto size = encode_status(packet, sizeof packet, 0x01, error{error::OK, false}, data, data + sizeof data);
+  ring.push(packet, packet + size);
+
+  sentry s;
+  while (!s(ring()))
+    ;
+  auto maybe_data = t << ring;
+  TEST_ASSERT_TRUE(maybe_data.has_value());
+  TEST_ASSERT_EQUAL(static_cast<std::int32_t>(0xfdffff00), maybe_data->value);
+  TEST_ASSERT_TRUE(ring.empty());
+}
+
+static void ring_DO_give_up_waiting_for_a_packet_after_the_spin_limit() {
+  using namespace ldp;
+
+  static byte_ring<64> ring{16};
+  TEST_ASSERT_EQUAL(16, ring.spin_limit());
+  TEST_ASSERT_FALSE(detail::seek_header(ring, 1000));
+  TEST_ASSERT_TRUE(ring.timed_out());
+
+  // Once timed out, the ring does not wait anymore but still delivers the bytes it holds
+  ring.push(0x42);
+  TEST_ASSERT_EQUAL(0x42, ring());
+  TEST_ASSERT_EQUAL(0, ring());
+  TEST_ASSERT_TRUE(ring.timed_out());
+
+  ring.clear();
+  const upd::byte_t header[] = {0xff, 0xff, 0xfd, 0x00};
+  ring.push(header, header + sizeof header);
+  TEST_ASSERT_TRUE(detail::seek_header(ring, 1000));
+  TEST_ASSERT_FALSE(ring.timed_out());
+}
+
+static void ring_DO_transfer_bytes_between_two_threads() {
+  using namespace ldp;
+
+  constexpr std::size_t total = 1 << 20;
+  static byte_ring<256> ring;
+
+  // The producer alternates between byte per byte writes, bulk writes and in-place writes, and so does the consumer
+  std::thread producer{[]() {
+    upd::byte_t chunk[97];
+    for (std::size_t sent = 0; sent < total;) {
+      switch (sent % 3) {
+      case 0:
+        ring(static_cast<upd::byte_t>(sent++));
+        break;
+      case 1: {
+        auto count = std::min(sizeof chunk, total - sent);
+        for (std::size_t i = 0; i < count; ++i)
+          chunk[i] = static_cast<upd::byte_t>(sent + i);
+        count = ring.push(chunk, chunk + count);
+        if (count == 0)
+          std::this_thread::yield();
+        sent += count;
+        break;
+      }
+      default: {
+        auto region = ring.write_region();
+        auto count = std::min(region.size(), total - sent);
+        for (std::size_t i = 0; i < count; ++i)
+          (i < region.first.size ? region.first.data[i] : region.second.data[i - region.first.size]) =
+              static_cast<upd::byte_t>(sent + i);
+        ring.commit(count);
+        if (count == 0)
+          std::this_thread::yield();
+        sent += count;
+      }
+      }
+    }
+  }};
+
+  std::size_t received = 0, mismatches = 0;
+  upd::byte_t chunk[61];
+  while (received < total) {
+    switch (received % 3) {
+    case 0:
+      mismatches += ring() != static_cast<upd::byte_t>(received++);
+      break;
+    case 1: {
+      auto count = ring.pop(chunk, sizeof chunk);
+      if (count == 0)
+        std::this_thread::yield();
+      for (std::size_t i = 0; i < count; ++i)
+        mismatches += chunk[i] != static_cast<upd::byte_t>(received + i);
+      received += count;
+      break;
+    }
+    default: {
+      auto region = ring.read_region();
+      for (std::size_t i = 0; i < region.first.size; ++i)
+        mismatches += region.first.data[i] != static_cast<upd::byte_t>(received + i);
+      for (std::size_t i = 0; i < region.second.size; ++i)
+        mismatches += region.second.data[i] != static_cast<upd::byte_t>(received + region.first.size + i);
+      ring.consume(region.size());
+      if (region.size() == 0)
+        std::this_thread::yield();
+      received += region.size();
+    }
+    }
+  }
+
+  producer.join();
+  TEST_ASSERT_EQUAL(total, received);
+  TEST_ASSERT_EQUAL(0, mismatches);
+  TEST_ASSERT_TRUE(ring.empty());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(ring_DO_expose_two_regions_when_wrapping_around);
+  RUN_TEST(ring_DO_carry_a_request_and_its_response);
+  RUN_TEST(ring_DO_give_up_waiting_for_a_packet_after_the_spin_limit);
+  RUN_TEST(ring_DO_transfer_bytes_between_two_threads);
+  return UNITY_END();
+}
@@ -0,0 +1,95 @@
+#include <ldp/parser.hpp>
+#include <ldp/ping.hpp>
+#include <ldp/router.hpp>
+
+#include "utility.hpp"
+
+constexpr upd::byte_t stream[] = {0xff, 0xff, 0xfd, 0x00, 0x02, 0x07, 0x00, 0x55, 0x00, 0x06, 0x04, 0x27, 0x6a, 0xed,
+                                  0xff, 0xff, 0xfd, 0x00, 0x01, 0x07, 0x00, 0x55, 0x00, 0x06, 0x04, 0x26, 0x65, 0x5d,
+                                  0xff, 0xff, 0xfd, 0x00, 0x01, 0x07, 0x00, 0x55, 0x00, 0x06, 0x04, 0x26, 0x65, 0x5d,
+                                  0xff, 0xff, 0xfd, 0x00, 0x02, 0x07, 0x00, 0x55, 0x00, 0x06, 0x04, 0x27, 0x6a, 0xed,
+                                  0xff, 0xff, 0xfd, 0x00, 0x02, 0x07, 0x00, 0x55, 0x00, 0x06, 0x04, 0x27, 0x6a, 0xed};
+
+static int firmware_versions;
+
+static void router_DO_dispatch_responses_to_their_tickets() {
+  using namespace ldp;
+
+  router<2> r;
+  auto hook = [](const device_info &info) { firmware_versions = firmware_versions * 100 + info.firmware_version; };
+  auto noop = [](upd::byte_t) {};
+
+  firmware_versions = 0;
+  TEST_ASSERT_TRUE(r.expect(0x01, ping(0x01).write(noop).with_hook(hook)));
+  TEST_ASSERT_TRUE(r.expect(0x02, ping(0x02).write(noop).with_hook(hook)));
+  TEST_ASSERT_TRUE(r.expect(0x02, ping(0x02).write(noop).with_hook(hook)));
+  TEST_ASSERT_FALSE(r.expect(0x02, ping(0x02).write(noop).with_hook(hook)));
+  TEST_ASSERT_FALSE(r.expect(broadcast, ping().write(noop).with_hook(hook)));
+  TEST_ASSERT_EQUAL(2, r.pending(0x02));
+
+  constexpr route_status expected[] = {route_status::DISPATCHED, route_status::DISPATCHED, route_status::DUPLICATE,
+                                       route_status::DISPATCHED, route_status::DUPLICATE};
+  std::size_t count = 0;
+  parser<16> p;
+  p.push(stream, stream + sizeof stream, [&](const tl::expected<frame, error> &maybe_frame) {
+    TEST_ASSERT_TRUE(maybe_frame.has_value());
+    auto result = r.dispatch(*maybe_frame);
+    TEST_ASSERT_TRUE(result.status == expected[count++]);
+    TEST_ASSERT_EQUAL(error::OK, result.err.type);
+  });
+
+  TEST_ASSERT_EQUAL(5, count);
+  TEST_ASSERT_EQUAL(393839, firmware_versions);
+  TEST_ASSERT_EQUAL(0, r.pending(0x01));
+  TEST_ASSERT_EQUAL(0, r.pending(0x02));
+}
+
+static void router_DO_report_orphan_responses() {
+  using namespace ldp;
+
+  router<> r;
+  auto hook = [](const device_info &) {};
+
+  frame f{0x03, instruction::RETURN, error::OK, nullptr, 0};
+  TEST_ASSERT_TRUE(r.dispatch(f).status == route_status::ORPHAN);
+
+  TEST_ASSERT_TRUE(r.expect(0x03, ping(0x03).write([](upd::byte_t) {}).with_hook(hook)));
+  r.cancel(0x03);
+  TEST_ASSERT_EQUAL(0, r.pending(0x03));
+  TEST_ASSERT_TRUE(r.dispatch(f).status == route_status::ORPHAN);
+
+  TEST_ASSERT_TRUE(r.expect(0x03, ping(0x03).write([](upd::byte_t) {}).with_hook(hook)));
+  auto result = r.dispatch(f);
+  TEST_ASSERT_TRUE(result.status == route_status::DISPATCHED);
+  TEST_ASSERT_EQUAL(error::BAD_LENGTH, result.err.type);
+}
+
+static void router_DO_leave_out_instruction_packets() {
+  using namespace ldp;
+
+  router<> r;
+  auto hook = [](const device_info &info) { firmware_versions = info.firmware_version; };
+
+  // The echo of the ping sent to the device must not be taken for its response
+  firmware_versions = 0;
+  TEST_ASSERT_TRUE(r.expect(0x01, ping(0x01).write([](upd::byte_t) {}).with_hook(hook)));
+  frame echo{0x01, instruction::PING, error::OK, nullptr, 0};
+  TEST_ASSERT_TRUE(r.dispatch(echo).status == route_status::NOT_STATUS);
+  TEST_ASSERT_EQUAL(1, r.pending(0x01));
+
+  parser<16> p;
+  p.push(stream + 14, stream + 28, [&](const tl::expected<frame, error> &maybe_frame) {
+    TEST_ASSERT_TRUE(maybe_frame.has_value());
+    TEST_ASSERT_TRUE(r.dispatch(*maybe_frame).status == route_status::DISPATCHED);
+  });
+  TEST_ASSERT_EQUAL(38, firmware_versions);
+  TEST_ASSERT_EQUAL(0, r.pending(0x01));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(router_DO_dispatch_responses_to_their_tickets);
+  RUN_TEST(router_DO_report_orphan_responses);
+  RUN_TEST(router_DO_leave_out_instruction_packets);
+  return UNITY_END();
+}
@@ -1,3 +1,4 @@
+#include <ldp/scanner.hpp>
 #include <ldp/sentry.hpp>
 
 #include "utility.hpp"
@@ -49,10 +50,42 @@ static void sentry_DO_detect_a_stuffing_byte() {
   TEST_ASSERT_EQUAL(6, i);
 }
 
+static void sentry_DO_find_the_same_sequences_as_the_scanner() {
+  using namespace ldp;
+
+  constexpr upd::byte_t alphabet[] = {0xff, 0xff, 0xff, 0xfd, 0xfd, 0x00, 0x12};
+  upd::byte_t buf[1024];
+  std::uint32_t seed = 0x12345678;
+  for (auto &byte : buf) {
+    seed = seed * 1103515245 + 12345;
+    byte = alphabet[(seed >> 16) % sizeof alphabet];
+  }
+
+  for (std::size_t size = 0; size <= sizeof buf; size += 61) {
+    std::size_t expected_headers[sizeof buf], expected_stuffing[sizeof buf], headers[sizeof buf], stuffing[sizeof buf];
+    std::size_t header_count = 0, stuffing_count = 0;
+
+    sentry s;
+    stuffing_sentry ss;
+    for (std::size_t i = 0; i < size; ++i) {
+      if (s(buf[i]))
+        expected_headers[header_count++] = i;
+      if (ss(buf[i]))
+        expected_stuffing[stuffing_count++] = i;
+    }
+
+    TEST_ASSERT_EQUAL(header_count, find_headers(buf, buf + size, headers, sizeof buf));
+    TEST_ASSERT_EQUAL_INT_ARRAY(expected_headers, headers, header_count);
+    TEST_ASSERT_EQUAL(stuffing_count, find_stuffing(buf, buf + size, stuffing, sizeof buf));
+    TEST_ASSERT_EQUAL_INT_ARRAY(expected_stuffing, stuffing, stuffing_count);
+  }
+}
+
 int main() {
   UNITY_BEGIN();
   RUN_TEST(sentry_DO_detect_a_header);
   RUN_TEST(sentry_DO_detect_multiple_headers);
   RUN_TEST(sentry_DO_detect_a_stuffing_byte);
+  RUN_TEST(sentry_DO_find_the_same_sequences_as_the_scanner);
   return UNITY_END();
 }
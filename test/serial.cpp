@@ -0,0 +1,181 @@
+#include <cstdlib>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <ldp/ping.hpp>
+#include <ldp/serial.hpp>
+#include <ldp/simulator.hpp>
+#include <ldp/simulator_pty.hpp>
+#include <ldp/sync_read.hpp>
+#include <ldp/write.hpp>
+
+#include "utility.hpp"
+
+struct fake_device {
+  explicit fake_device() : fd{posix_openpt(O_RDWR | O_NOCTTY)} {
+    TEST_ASSERT_TRUE(fd >= 0);
+    TEST_ASSERT_EQUAL(0, grantpt(fd));
+    TEST_ASSERT_EQUAL(0, unlockpt(fd));
+  }
+
+  ~fake_device() { close(fd); }
+
+  const char *path() const { return ptsname(fd); }
+
+  void serve(const std::vector<upd::byte_t> &expected, const std::vector<upd::byte_t> &answer) {
+    std::vector<upd::byte_t> buf(expected.size());
+    for (std::size_t i = 0; i < buf.size();) {
+      pollfd pfd{fd, POLLIN, 0};
+      TEST_ASSERT_EQUAL(1, poll(&pfd, 1, 1000));
+      auto count = read(fd, buf.data() + i, buf.size() - i);
+      TEST_ASSERT_TRUE(count > 0);
+      i += count;
+    }
+
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected.data(), buf.data(), expected.size());
+    TEST_ASSERT_EQUAL(answer.size(), write(fd, answer.data(), answer.size()));
+  }
+
+  int fd;
+};
+
+static void serial_DO_exchange_packets_with_a_device() {
+  using namespace ldp;
+
+  fake_device device;
+  auto maybe_bus = open_serial_bus(device.path(), 1000000);
+  TEST_ASSERT_TRUE(maybe_bus.has_value());
+  auto &bus = *maybe_bus;
+
+  // The library can be used along with <termios.h>, which tells that the port is in raw mode
+  termios settings;
+  auto fd = open(device.path(), O_RDWR | O_NOCTTY);
+  TEST_ASSERT_EQUAL(0, tcgetattr(fd, &settings));
+  close(fd);
+  TEST_ASSERT_EQUAL(0, settings.c_lflag & (ICANON | ECHO));
+  TEST_ASSERT_EQUAL(CS8, settings.c_cflag & CSIZE);
+
+  auto tk = ping(0x01) >> bus;
+  TEST_ASSERT_TRUE(bus.flush());
+  device.serve({0xff, 0xff, 0xfd, 0x00, 0x01, 0x03, 0x00, 0x01, 0x19, 0x4e},
+               {0x12, 0xff, 0xff, 0xfd, 0x00, 0x01, 0x07, 0x00, 0x55, 0x00, 0x06, 0x04, 0x26, 0x65, 0x5d});
+
+  auto maybe_info = bus.receive(tk);
+  TEST_ASSERT_TRUE(maybe_info.has_value());
+  TEST_ASSERT_EQUAL(0x01, maybe_info->id);
+  TEST_ASSERT_EQUAL(1030, maybe_info->model_number);
+  TEST_ASSERT_EQUAL(38, maybe_info->firmware_version);
+  TEST_ASSERT_FALSE(bus.timed_out());
+}
+
+static void serial_DO_send_a_packet_described_by_segments() {
+  using namespace ldp;
+
+  fake_device device;
+  auto maybe_bus = open_serial_bus(device.path(), 1000000);
+  TEST_ASSERT_TRUE(maybe_bus.has_value());
+  auto &bus = *maybe_bus;
+
+  constexpr upd::byte_t parameters[] = {0x74, 0x00, 0xff, 0xff, 0xfd, 0x00};
+  packet_segment segments[4];
+  packet_envelope envelope;
+  auto count = write_packet(segments, 4, envelope, upd::two_complement, 0x01, instruction::WRITE, parameters,
+                            parameters + sizeof parameters);
+  TEST_ASSERT_TRUE(bus.write(segments, count));
+  device.serve({0xff, 0xff, 0xfd, 0x00, 0x01, 0x0a, 0x00, 0x03, 0x74, 0x00, 0xff, 0xff, 0xfd, 0xfd, 0x00, 0x21, 0xe7},
+               {});
+}
+
+static void serial_DO_time_out_on_a_silent_device() {
+  using namespace ldp;
+
+  fake_device device;
+  auto maybe_bus = open_serial_bus(device.path(), 57600);
+  TEST_ASSERT_TRUE(maybe_bus.has_value());
+  auto &bus = *maybe_bus;
+  bus.timeout(std::chrono::milliseconds{5});
+
+  auto tk = ping(0x01) >> bus;
+  TEST_ASSERT_TRUE(bus.flush());
+  device.serve({0xff, 0xff, 0xfd, 0x00, 0x01, 0x03, 0x00, 0x01, 0x19, 0x4e}, {0xff, 0xff, 0xfd, 0x00, 0x01, 0x07});
+
+  auto maybe_info = bus.receive(tk);
+  TEST_ASSERT_FALSE(maybe_info.has_value());
+  TEST_ASSERT_EQUAL(error::TIMEOUT, maybe_info.error().type);
+  TEST_ASSERT_TRUE(bus.timed_out());
+
+  // The rest of the packet is not waited for once the bus timed out
+  bus.timeout(std::chrono::seconds{1});
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < 8; ++i)
+    TEST_ASSERT_EQUAL(0, bus());
+  TEST_ASSERT_TRUE(std::chrono::steady_clock::now() - start < std::chrono::seconds{1});
+
+  device.serve({}, {0xff, 0xff, 0xfd, 0x00});
+  TEST_ASSERT_TRUE(bus.await_header());
+  TEST_ASSERT_FALSE(bus.timed_out());
+}
+
+static void serial_DO_exchange_packets_with_a_simulator_behind_a_pseudoterminal() {
+  using namespace ldp;
+
+  simulator sim{1000000};
+  sim.add(0x01, 256, 1030, 38);
+  sim.add(0x02, 256, 1030, 38);
+  auto maybe_pty = open_simulator_pty(sim);
+  TEST_ASSERT_TRUE(maybe_pty.has_value());
+  auto &pty = *maybe_pty;
+  auto maybe_bus = open_serial_bus(pty.path(), 1000000);
+  TEST_ASSERT_TRUE(maybe_bus.has_value());
+  auto &bus = *maybe_bus;
+
+  auto serve = [&]() {
+    auto instructions = sim.report().instructions;
+    while (sim.report().instructions == instructions)
+      TEST_ASSERT_TRUE(pty.serve(std::chrono::seconds{1}) != 0);
+  };
+
+  auto t_ping = ping(0x01) >> bus;
+  TEST_ASSERT_TRUE(bus.flush());
+  serve();
+  auto maybe_info = bus.receive(t_ping);
+  TEST_ASSERT_TRUE(maybe_info.has_value());
+  TEST_ASSERT_EQUAL(1030, maybe_info->model_number);
+  TEST_ASSERT_EQUAL(38, maybe_info->firmware_version);
+
+  auto t_write = write(0x02, memzone<116, std::uint32_t>{}, 0xfdffff) >> bus;
+  TEST_ASSERT_TRUE(bus.flush());
+  serve();
+  TEST_ASSERT_TRUE(bus.receive(t_write).has_value());
+
+  auto t_sync = sync_read(memzone<116, std::uint32_t>{}, 1, 2) >> bus;
+  TEST_ASSERT_TRUE(bus.flush());
+  serve();
+  packet_id ids[2];
+  std::uint32_t values[2];
+  error errors[2];
+  TEST_ASSERT_TRUE(bus.await_header());
+  TEST_ASSERT_EQUAL(2, t_sync.receive(bus, ids, values, errors));
+  TEST_ASSERT_EQUAL(0, values[0]);
+  TEST_ASSERT_EQUAL(0xfdffff, values[1]);
+}
+
+static void serial_DO_fail_to_open_a_missing_port() {
+  auto maybe_bus = ldp::open_serial_bus("/dev/ldp-missing-port", 57600);
+  TEST_ASSERT_FALSE(maybe_bus.has_value());
+  TEST_ASSERT_EQUAL(ENOENT, maybe_bus.error().value());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(serial_DO_exchange_packets_with_a_device);
+  RUN_TEST(serial_DO_send_a_packet_described_by_segments);
+  RUN_TEST(serial_DO_time_out_on_a_silent_device);
+  RUN_TEST(serial_DO_exchange_packets_with_a_simulator_behind_a_pseudoterminal);
+  RUN_TEST(serial_DO_fail_to_open_a_missing_port);
+  return UNITY_END();
+}
@@ -0,0 +1,190 @@
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <tuple>
+#include <utility>
+
+#include <ldp/bulk.hpp>
+#include <ldp/ping.hpp>
+#include <ldp/read.hpp>
+#include <ldp/sentry.hpp>
+#include <ldp/simulator.hpp>
+#include <ldp/sync_read.hpp>
+#include <ldp/sync_write.hpp>
+#include <ldp/write.hpp>
+
+#include "utility.hpp"
+
+static bool await_header(ldp::simulator &sim) {
+  ldp::sentry s;
+  while (!s(sim())) {
+    if (sim.timed_out())
+      return false;
+  }
+  return true;
+}
+
+static void simulator_DO_answer_ping_write_and_read() {
+  using namespace ldp;
+
+  simulator sim{1000000};
+  sim.add(0x01, 256, 1020, 52);
+
+  auto t_ping = ping(0x01) >> sim;
+  TEST_ASSERT_TRUE(await_header(sim));
+  auto maybe_info = t_ping << sim;
+  TEST_ASSERT_TRUE(maybe_info.has_value());
+  TEST_ASSERT_EQUAL(1020, maybe_info->model_number);
+  TEST_ASSERT_EQUAL(52, maybe_info->firmware_version);
+
+  // A 10-byte ping, a 250 us return delay and a 14-byte status packet at 10 us per byte
+  TEST_ASSERT_TRUE(sim.time() == std::chrono::microseconds{490});
+
+  auto t_write = write(0x01, memzone<116, std::int32_t>{}, -2048) >> sim;
+  TEST_ASSERT_TRUE(await_header(sim));
+  TEST_ASSERT_TRUE((t_write << sim).has_value());
+
+  auto t_read = read(0x01, memzone<116, std::int32_t>{}) >> sim;
+  TEST_ASSERT_TRUE(await_header(sim));
+  auto maybe_data = t_read << sim;
+  TEST_ASSERT_TRUE(maybe_data.has_value());
+  TEST_ASSERT_EQUAL(-2048, maybe_data->value);
+
+  auto t_out_of_range = read(0x01, memzone<254, std::int32_t>{}) >> sim;
+  TEST_ASSERT_TRUE(await_header(sim));
+  auto maybe_error = t_out_of_range << sim;
+  TEST_ASSERT_FALSE(maybe_error.has_value());
+  TEST_ASSERT_EQUAL(error::ACCESS, maybe_error.error().type);
+
+  auto report = sim.report();
+  TEST_ASSERT_EQUAL(4, report.instructions);
+  TEST_ASSERT_EQUAL(4, report.responses);
+  TEST_ASSERT_EQUAL(0, sim.pending());
+}
+
+static void simulator_DO_answer_sync_instructions_with_injected_faults() {
+  using namespace ldp;
+
+  simulator sim;
+  for (packet_id id = 1; id <= 3; ++id)
+    sim.add(id);
+
+  // The values are serialized as 'ff ff fd', so that the status packets are stuffed
+  sync_write(memzone<116, std::uint32_t>{}, device_data<std::uint32_t>{1, 0x00fdffff},
+             device_data<std::uint32_t>{2, 0xfdffff00}, device_data<std::uint32_t>{3, 3}) >>
+      sim;
+  TEST_ASSERT_EQUAL(0, sim.pending());
+
+  sim.inject_error(2, error{error::DATA_LIMIT, true});
+  auto t_sync = sync_read(memzone<116, std::uint32_t>{}, 1, 2, 3) >> sim;
+  packet_id ids[3];
+  std::uint32_t values[3];
+  error errors[3];
+  TEST_ASSERT_TRUE(await_header(sim));
+  TEST_ASSERT_EQUAL(2, t_sync.receive(sim, ids, values, errors));
+  TEST_ASSERT_EQUAL(0x00fdffff, values[0]);
+  TEST_ASSERT_EQUAL(error::DATA_LIMIT, errors[1].type);
+  TEST_ASSERT_TRUE(errors[1].alert);
+  TEST_ASSERT_EQUAL(3, values[2]);
+
+  auto t_fast = fast_sync_read(memzone<116, std::uint32_t>{}, 1, 2, 3) >> sim;
+  TEST_ASSERT_TRUE(await_header(sim));
+  TEST_ASSERT_EQUAL(3, t_fast.receive(sim, ids, values, errors));
+  TEST_ASSERT_EQUAL(0x00fdffff, values[0]);
+  TEST_ASSERT_EQUAL(0xfdffff00, values[1]);
+  TEST_ASSERT_EQUAL(3, values[2]);
+
+  sim.drop_responses(1);
+  auto t_dropped = read(0x01, memzone<116, std::uint32_t>{}) >> sim;
+  static_cast<void>(t_dropped);
+  TEST_ASSERT_FALSE(await_header(sim));
+
+  sim.clear();
+  sim.corrupt_responses(1);
+  auto t_corrupted = read(0x01, memzone<116, std::uint32_t>{}) >> sim;
+  TEST_ASSERT_TRUE(await_header(sim));
+  auto maybe_data = t_corrupted << sim;
+  TEST_ASSERT_FALSE(maybe_data.has_value());
+  TEST_ASSERT_EQUAL(error::RECEIVED_BAD_CRC, maybe_data.error().type);
+}
+
+static void simulator_DO_report_the_devices_missing_from_a_sync_read() {
+  using namespace ldp;
+
+  simulator sim;
+  for (packet_id id = 1; id <= 3; ++id)
+    sim.add(id);
+
+  packet_id ids[3];
+  std::uint32_t values[3];
+  error errors[3];
+
+  sim.drop_responses(2);
+  auto t_middle = sync_read(memzone<116, std::uint32_t>{}, 1, 2, 3) >> sim;
+  TEST_ASSERT_TRUE(await_header(sim));
+  TEST_ASSERT_EQUAL(2, t_middle.receive(sim, ids, values, errors));
+  const packet_id expected_ids[] = {1, 2, 3};
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected_ids, ids, 3);
+  TEST_ASSERT_EQUAL(error::OK, errors[0].type);
+  TEST_ASSERT_EQUAL(error::TIMEOUT, errors[1].type);
+  TEST_ASSERT_EQUAL(error::OK, errors[2].type);
+
+  sim.clear();
+  sim.drop_responses(3);
+  auto t_last = sync_read(memzone<116, std::uint32_t>{}, 1, 2, 3) >> sim;
+  TEST_ASSERT_TRUE(await_header(sim));
+  TEST_ASSERT_EQUAL(2, t_last.receive(sim, ids, values, errors));
+  TEST_ASSERT_EQUAL(error::OK, errors[1].type);
+  TEST_ASSERT_EQUAL(error::TIMEOUT, errors[2].type);
+}
+
+static void simulator_DO_report_the_devices_missing_from_a_bulk_read() {
+  using namespace ldp;
+
+  simulator sim;
+  sim.add(1);
+  sim.add(2);
+
+  sim.drop_responses(2);
+  auto first = std::make_pair(1, memzone<132, std::uint32_t>{});
+  auto second = std::make_pair(2, memzone<65, std::uint8_t>{});
+  auto t = bulk_read(first, second) >> sim;
+  TEST_ASSERT_TRUE(await_header(sim));
+  auto response = t << sim;
+  TEST_ASSERT_TRUE(std::get<0>(response).has_value());
+  TEST_ASSERT_FALSE(std::get<1>(response).has_value());
+  TEST_ASSERT_EQUAL(error::TIMEOUT, std::get<1>(response).error().type);
+}
+
+static void simulator_DO_match_the_bulk_read_responses_with_their_device() {
+  using namespace ldp;
+
+  simulator sim;
+  for (packet_id id = 1; id <= 3; ++id)
+    sim.add(id);
+  sim.memory(3)[65] = 0x2a;
+
+  sim.drop_responses(2);
+  auto first = std::make_pair(1, memzone<132, std::uint32_t>{});
+  auto second = std::make_pair(2, memzone<132, std::uint32_t>{});
+  auto third = std::make_pair(3, memzone<65, std::uint8_t>{});
+  auto t = bulk_read(first, second, third) >> sim;
+  TEST_ASSERT_TRUE(await_header(sim));
+  auto response = t << sim;
+  TEST_ASSERT_TRUE(std::get<0>(response).has_value());
+  TEST_ASSERT_FALSE(std::get<1>(response).has_value());
+  TEST_ASSERT_EQUAL(error::TIMEOUT, std::get<1>(response).error().type);
+  TEST_ASSERT_TRUE(std::get<2>(response).has_value());
+  TEST_ASSERT_EQUAL(0x03, std::get<2>(response)->id);
+  TEST_ASSERT_EQUAL_UINT8(0x2a, std::get<2>(response)->value);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(simulator_DO_answer_ping_write_and_read);
+  RUN_TEST(simulator_DO_answer_sync_instructions_with_injected_faults);
+  RUN_TEST(simulator_DO_report_the_devices_missing_from_a_sync_read);
+  RUN_TEST(simulator_DO_report_the_devices_missing_from_a_bulk_read);
+  RUN_TEST(simulator_DO_match_the_bulk_read_responses_with_their_device);
+  return UNITY_END();
+}